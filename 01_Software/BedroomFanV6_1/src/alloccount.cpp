@@ -0,0 +1,81 @@
+#include "alloccount.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <new>
+
+extern "C" {
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void  __real_free(void *ptr);
+}
+
+// ======== STATE =====================
+static TaskHandle_t countingTask = nullptr;
+static AllocCount counted;
+
+// ======== HELPERS ===================
+static inline void count(size_t size) {
+  if (countingTask != nullptr && xTaskGetCurrentTaskHandle() == countingTask) {
+    counted.allocations++;
+    counted.bytes += size;
+  }
+}
+
+// ======== WRAPPERS ==================
+extern "C" void *__wrap_malloc(size_t size) {
+  count(size);
+  return __real_malloc(size);
+}
+
+extern "C" void *__wrap_calloc(size_t count_, size_t size) {
+  count(count_ * size);
+  return __real_calloc(count_, size);
+}
+
+extern "C" void *__wrap_realloc(void *ptr, size_t size) {
+  if (size > 0) count(size);
+  return __real_realloc(ptr, size);
+}
+
+extern "C" void __wrap_free(void *ptr) {
+  __real_free(ptr);
+}
+
+// The host links libstdc++ as a shared library, its own calls to malloc
+// are not wrapped; replacing operator new covers both builds
+void *operator new(size_t size) {
+  void *ptr = malloc(size ? size : 1);
+  if (!ptr) throw std::bad_alloc();
+  return ptr;
+}
+
+void *operator new[](size_t size) {
+  return operator new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+  return malloc(size ? size : 1);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept {
+  return malloc(size ? size : 1);
+}
+
+void operator delete(void *ptr) noexcept           { free(ptr); }
+void operator delete[](void *ptr) noexcept         { free(ptr); }
+void operator delete(void *ptr, size_t) noexcept   { free(ptr); }
+void operator delete[](void *ptr, size_t) noexcept { free(ptr); }
+
+// ======== PUBLIC API ================
+void allocCountStart() {
+  counted = AllocCount();
+  countingTask = xTaskGetCurrentTaskHandle();
+}
+
+AllocCount allocCountStop() {
+  countingTask = nullptr;
+  return counted;
+}
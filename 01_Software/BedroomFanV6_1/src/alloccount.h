@@ -0,0 +1,22 @@
+#pragma once
+
+#include <Arduino.h>
+
+/*
+Count of heap allocations made by the calling task.
+
+malloc, calloc, realloc and free are wrapped at link time (-Wl,--wrap in
+platformio.ini), operator new and delete are replaced to go through them.
+Outside a count the wrappers cost one comparison per allocation.
+Allocations of other tasks (WiFi, lwIP) are not counted.
+*/
+
+// ======== TYPES ================
+struct AllocCount {
+  uint32_t allocations = 0;
+  uint32_t bytes = 0;
+};
+
+// ======== FUNCTIONS ================
+void allocCountStart();      // Count the allocations of the calling task from now on
+AllocCount allocCountStop(); // Stop counting, returns the allocations since the start
@@ -0,0 +1,99 @@
+#include "bench.h"
+
+#include <string>
+
+#include "clock.h"
+#include "eventlog.h"
+#include "alloccount.h"
+#include "localclock.h"
+#include "prometheus.h"
+#include "hal.h"
+
+// ======== CONSTANTS =================
+constexpr uint32_t TARGET_PER_SECOND = 50;     // Measure each benchmark for 1/50 s
+constexpr uint32_t MAX_ITERATIONS    = 1 << 16;
+
+// ======== TYPES =====================
+typedef void (*benchFunction_t)();
+
+struct Benchmark {
+  const char     *name;
+  benchFunction_t function;
+};
+
+// ======== STATE =====================
+volatile uint32_t benchSink = 0;
+
+static TimeOfDay benchTime(7, 30);
+static const char *TIME_TEXT = "07:30";
+static const String EVENT = "Fan switched on by Bench User";
+static time_t benchEpoch = 1751364000; // July 1st 2025, advances a second per call
+
+// ======== BENCHMARKS ================
+static void benchParse()            { benchSink = benchTime.parse(TIME_TEXT); }
+static void benchToString()         { benchSink = benchTime.to_string().length(); }
+static void benchToArduinoString()  { benchSink = benchTime.to_String().length(); }
+static void benchText()             { benchSink = benchTime.text().text[0]; }
+static void benchAddToEventLog()    { addToEventLog(EVENT); }
+static void benchEventLogAsString() { benchSink = getEventLogAsString().length(); } // Full after the previous one
+static void benchLocaltime()        { struct tm t; time_t e = benchEpoch++; localtime_r(&e, &t); benchSink = t.tm_min; }
+static void benchLocalClockAt()     { struct tm t; localClockAt(benchEpoch++, &t); benchSink = t.tm_min; }
+
+// A full scrape of /metrics through a response sized buffer
+static void benchPrometheus() {
+  static char out[3072];
+  uint32_t cursor = 0;
+  while (size_t length = prometheusRender(out, sizeof(out), cursor)) benchSink += length;
+}
+
+static const Benchmark BENCHMARKS[] = {
+  { "TimeOfDay::parse",     benchParse            },
+  { "TimeOfDay::to_string", benchToString         },
+  { "TimeOfDay::to_String", benchToArduinoString  },
+  { "TimeOfDay::text",      benchText             },
+  { "addToEventLog",        benchAddToEventLog    },
+  { "getEventLogAsString",  benchEventLogAsString },
+  { "localtime_r",          benchLocaltime        },
+  { "localClockAt",         benchLocalClockAt     },
+  { "prometheusRender",     benchPrometheus       },
+  { "StatusMessage",        benchStatusMessage    },
+  { "callback dispatch",    benchCallbackDispatch },
+  { "build keyboards",      benchBuildKeyboards   },
+};
+
+// ======== HELPERS ===================
+static uint32_t timeIterations(benchFunction_t function, uint32_t iterations) {
+  uint32_t start = halCycleCount();
+  for (uint32_t i = 0; i < iterations; i++) function();
+  return halCycleCount() - start;
+}
+
+static String measure(const Benchmark &b) {
+  uint32_t target = halCycleHz() / TARGET_PER_SECOND;
+
+  // Double the count until one run takes long enough to time
+  b.function();
+  uint32_t iterations = 1;
+  while (iterations < MAX_ITERATIONS && timeIterations(b.function, iterations) < target / 2) iterations *= 2;
+
+  allocCountStart();
+  uint32_t cycles = timeIterations(b.function, iterations);
+  AllocCount allocs = allocCountStop();
+
+  char line[96];
+  snprintf(line, sizeof(line), "%s: %.0f ns, %.1f allocs, %.0f B\n", b.name,
+           cycles * (1e9 / halCycleHz()) / iterations,
+           (double)allocs.allocations / iterations, (double)allocs.bytes / iterations);
+  return String(line);
+}
+
+// ======== PUBLIC API ================
+String runBenchmarks() {
+  String result = "Benchmark: time, heap allocations and bytes per operation\n";
+
+  stashEventLog();
+  for (const Benchmark &b : BENCHMARKS) result += measure(b);
+  unstashEventLog();
+
+  return result;
+}
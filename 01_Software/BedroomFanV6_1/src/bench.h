@@ -0,0 +1,29 @@
+#pragma once
+
+#include <Arduino.h>
+
+/*
+Microbenchmarks of the functions that run on every loop or every tap.
+
+Each benchmark repeats one operation until about 20 ms have passed and
+reports the time per operation, and the heap allocations and bytes per
+operation (see alloccount.h). Time is taken from the CPU cycle counter on
+the board, so /bench runs from the Telegram job, which holds the CPU at
+full speed. The host build counts nanoseconds:
+
+  program --bench
+
+The event log is set aside while the benchmarks fill it, the fan and the
+settings are not touched.
+*/
+
+// ======== STATE ================
+extern volatile uint32_t benchSink; // Results go here, so the compiler cannot drop the work
+
+// ======== FUNCTIONS ================
+String runBenchmarks(); // One line per benchmark: ns/op, allocations/op, bytes/op
+
+// Benchmarks of the Telegram handlers, without Bot API calls (telegram.cpp)
+void benchStatusMessage();
+void benchCallbackDispatch();
+void benchBuildKeyboards();
@@ -0,0 +1,62 @@
+#include "boot.h"
+
+#include "eventlog.h"
+
+// ======== CONSTANTS =================
+struct BootStageInfo {
+  const char *name;
+  uint8_t dependencies; // Bit mask of stages that must be done first
+};
+
+#define DEP(stage) (1 << (stage))
+
+static const BootStageInfo STAGES[BS_COUNT] = {
+  { "relay",         0                                 },
+  { "serial",        0                                 },
+  { "telegram",      0                                 },
+  { "wifi",          0                                 },
+  { "time",          0                                 },
+  { "welcome",       DEP(bsWifi) | DEP(bsTelegram)     },
+  { "first poll",    DEP(bsWelcome)                    },
+  { "first command", DEP(bsFirstPoll)                  },
+};
+
+// The boot is complete when these are done, the first command may take days
+constexpr uint8_t BOOT_COMPLETE = DEP(bsRelay) | DEP(bsSerial) | DEP(bsTelegram) |
+                                  DEP(bsWifi) | DEP(bsWelcome) | DEP(bsFirstPoll);
+
+// ======== STATE =====================
+static unsigned long stamps[BS_COUNT];
+static uint8_t done = 0;
+static bool reported = false;
+
+// ======== PUBLIC API ================
+void bootStageDone(bootStage_t stage) {
+  if (done & DEP(stage)) return;
+  stamps[stage] = millis();
+  done |= DEP(stage);
+}
+
+bool bootStageIsDone(bootStage_t stage) {
+  return done & DEP(stage);
+}
+
+bool bootStageReady(bootStage_t stage) {
+  return (done & STAGES[stage].dependencies) == STAGES[stage].dependencies;
+}
+
+void loopBoot() {
+  if (reported || (done & BOOT_COMPLETE) != BOOT_COMPLETE) return;
+  reported = true;
+  addToEventLog(String("Boot completed: ") + bootReport());
+}
+
+String bootReport() {
+  String result;
+  for (int stage = 0; stage < BS_COUNT; stage++) {
+    if (!(done & DEP(stage))) continue;
+    if (result.length() > 0) result += ", ";
+    result += String(STAGES[stage].name) + " " + String(stamps[stage]) + " ms";
+  }
+  return result;
+}
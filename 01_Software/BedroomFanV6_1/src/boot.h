@@ -0,0 +1,33 @@
+#pragma once
+
+#include <Arduino.h>
+
+/*
+Boot stages and their timing.
+
+setup() only does the quick stages (relay, serial, Telegram token). WiFi,
+time and the welcome message complete later from loop(), each as soon as
+the stages it depends on are done. Every stage is stamped once with the
+time since boot, so time-to-relay-control and time-to-first-command can be
+tracked.
+*/
+
+// ======== TYPES ================
+enum bootStage_t {
+  bsRelay,        // Relay driven to its restored or default state
+  bsSerial,       // Serial port ready
+  bsTelegram,     // Bot token and keyboards set up
+  bsWifi,         // First WiFi connection
+  bsTime,         // Clock set by any time source
+  bsWelcome,      // Welcome message sent, needs WiFi and Telegram
+  bsFirstPoll,    // First Telegram poll completed, needs the welcome
+  bsFirstCommand, // First command from a user handled
+  BS_COUNT
+};
+
+// ======== FUNCTIONS ================
+void bootStageDone(bootStage_t stage);   // Stamp a stage, only the first call counts
+bool bootStageIsDone(bootStage_t stage);
+bool bootStageReady(bootStage_t stage);  // All dependencies of the stage are done
+void loopBoot();                         // Logs the report once the boot has completed
+String bootReport();                     // "relay 2 ms, serial 3 ms, ..."
@@ -1,11 +1,10 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include <stdlib.h>
-#include <sstream>
-#include <iomanip>
 #include <Arduino.h>
 
 #include "clock.h"
+#include "timefmt.h"
 
 TimeOfDay::TimeOfDay(int hours, int minutes) {
     minutes_after_midnight = hours * 60 + minutes;
@@ -25,19 +24,9 @@ void TimeOfDay::add_minutes(int mins) {
 }
 
 // Parse "h:mm" or "hh:mm"
-bool TimeOfDay::parse(const std::string& s) {
-    int h, m;
-    char colon;
-
-    std::istringstream iss(s);
-    if (!(iss >> h >> colon >> m))
-        return false;
-    if (colon != ':')
-        return false;
-    if (h < 0 || h > 23 || m < 0 || m > 59)
+bool TimeOfDay::parse(const char *s) {
+    if (!parseClock(s, minutes_after_midnight))
         return false;
-
-    minutes_after_midnight = h * 60 + m;
     range_check();
     return true;
 }
@@ -48,20 +37,15 @@ bool TimeOfDay::is_due(int now_hours, int now_minutes) const {
     return now >= minutes_after_midnight;
 }
 
-// Optional: return string like "hh:mm"
+// Optional: return string like "h:mm"
 String TimeOfDay::to_String() const {
-    int h = minutes_after_midnight / 60;
-    int m = minutes_after_midnight % 60;
-    return String(h) + ":" + (m < 10 ? "0" : "") + String(m);
+    return String(text().c_str());
 }
 
 std::string TimeOfDay::to_string() const {
-    int h = minutes_after_midnight / 60;
-    int m = minutes_after_midnight % 60;
+    return std::string(formatClock(minutes_after_midnight).c_str());
+}
 
-    std::ostringstream oss;
-    oss << std::setw(2) << std::setfill('0') << h
-        << ":"
-        << std::setw(2) << std::setfill('0') << m;
-    return oss.str();
+ClockText TimeOfDay::text() const {
+    return formatClock(minutes_after_midnight, false);
 }
@@ -18,6 +18,11 @@ int main() {
 }
 */
 
+#include <string>
+#include <Arduino.h>
+
+#include "timefmt.h"
+
 struct TimeOfDay {
     int minutes_after_midnight = 0;
 
@@ -27,9 +32,11 @@ struct TimeOfDay {
 
     void range_check();
     void add_minutes(int mins);
-    bool parse(const std::string& s); // Parse "h:mm" or "hh:mm"
+    bool parse(const char *s); // Parse "h:mm" or "hh:mm"
+    bool parse(const std::string& s) { return parse(s.c_str()); }
     bool is_due(int now_hours, int now_minutes) const;
 
-    String to_String() const; // Optional: return string like "hh:mm"
-    std::string to_string() const;
+    String to_String() const; // Optional: return string like "h:mm"
+    std::string to_string() const; // "hh:mm"
+    ClockText text() const;   // "h:mm" without the heap
 };
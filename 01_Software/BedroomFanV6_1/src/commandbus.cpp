@@ -0,0 +1,207 @@
+#include "commandbus.h"
+
+#include "fancontrol.h"
+#include "eventlog.h"
+#include "metrics.h"
+#include "scheduler.h"
+#include "power.h"
+#include "perf.h"
+#include "settings.h"
+#include "boot.h"
+#include "timesync.h"
+#include "wifi_connect.h"
+#include "version.h"
+#include "mqtt.h"
+#include "remotelog.h"
+
+// ======== CONSTANTS =================
+constexpr size_t MAX_QUEUED = 8;
+
+static const commandPriority_t PRIORITIES[CM_COUNT] = {
+  cpRelay, cpRelay, cpRelay, cpRelay,
+  cpSettings, cpSettings,
+  cpDiagnostics, cpDiagnostics, cpDiagnostics, cpDiagnostics, cpDiagnostics, cpDiagnostics,
+  cpLogDump, cpLogDump,
+};
+
+static const char *ORIGIN_NAMES[] = { "telegram", "serial", "network" };
+
+static const char *TIMER_TEXT[] = { "20 minutes", "1 hour", "4 hours" };
+
+// ======== STATE =====================
+struct Queued {
+  Command  command;
+  uint32_t sequence; // Order of posting, first in first out within a priority
+};
+
+static Queued queue[MAX_QUEUED];
+static size_t queued = 0;
+static uint32_t nextSequence = 0;
+static job_t busJob = NO_JOB;
+
+// ======== HELPERS ===================
+static String who(const Command &command) {
+  return command.user + " (" + originName(command.origin) + ")";
+}
+
+// true if a should run before b
+static bool before(const Queued &a, const Queued &b) {
+  commandPriority_t pa = commandPriority(a.command.type);
+  commandPriority_t pb = commandPriority(b.command.type);
+  return pa < pb || (pa == pb && (int32_t)(a.sequence - b.sequence) < 0);
+}
+
+static size_t mostUrgent() {
+  size_t best = 0;
+  for (size_t i = 1; i < queued; i++) if (before(queue[i], queue[best])) best = i;
+  return best;
+}
+
+static size_t leastUrgent() {
+  size_t worst = 0;
+  for (size_t i = 1; i < queued; i++) if (before(queue[worst], queue[i])) worst = i;
+  return worst;
+}
+
+static Command take(size_t index) {
+  Command command = queue[index].command;
+  queue[index] = queue[--queued];
+  queue[queued].command = Command(); // Release the strings
+  return command;
+}
+
+static String fanStatus() {
+  switch (fanMode) {
+    case fsOn:    return "Fan is permanently switched on";
+    case fsOff:   return "Fan is permanently switched off";
+    case fsTimer:
+      if (fanTimer.remaining() >= MS_PER_MIN)
+        return String("Fan will switch off after ") + String(fanTimer.remaining() / MS_PER_MIN) + " minutes";
+      return String("Fan will switch off after ") + String(fanTimer.remaining() / MS_PER_SEC) + " seconds";
+    case fsClock: return String("Fan is switched on between ") + clock_on.text() + " and " + clock_off.text() +
+                         ". It is currently " + (fanIsOn() ? "on." : "off.");
+  }
+  return "";
+}
+
+// Move one end of the clock window, the other end keeps 15 minutes away
+static String shiftClock(const Command &command) {
+  if (command.type == cmClockOnShift) {
+    clock_on.add_minutes(command.argument);
+    if (clock_on.minutes_after_midnight >= clock_off.minutes_after_midnight) {
+      clock_on.minutes_after_midnight = clock_off.minutes_after_midnight - 15;
+    }
+  } else {
+    clock_off.add_minutes(command.argument);
+    if (clock_off.minutes_after_midnight <= clock_on.minutes_after_midnight) {
+      clock_off.minutes_after_midnight = clock_on.minutes_after_midnight + 15;
+    }
+  }
+  addToEventLog(String("Clock time changed by ") + who(command));
+  markSettingsDirty();
+  clockWindowChanged();
+  return String("Fan on from ") + clock_on.text() + " until " + clock_off.text();
+}
+
+static String info() {
+  String result = String("Software version: ") + bf_version + "\n";
+  result += wifiConnectedTo() + "\n";
+  result += timeSyncStatus() + "\n";
+  result += mqttStatus() + "\n";
+  result += remoteLogStatus() + "\n";
+  result += String("Boot: ") + bootReport() + "\n";
+  result += String("WiFi association ") + String(wifiAssociationTime()) + " ms\n";
+  result += String("Settings written ") + String(settingsWriteCount()) + " times\n";
+  return result;
+}
+
+static String execute(const Command &command) {
+  switch (command.type) {
+    case cmFanOn:
+      setFanModeOn();
+      addToEventLog(String("Fan switched on by ") + who(command));
+      switchOnFan();
+      return fanStatus();
+    case cmFanOff:
+      setFanModeOff();
+      addToEventLog(String("Fan switched off by ") + who(command));
+      switchOffFan();
+      return fanStatus();
+    case cmFanClock:
+      addToEventLog(String("Fan switched to clock mode by ") + who(command));
+      setFanModeClock();
+      return fanStatus();
+    case cmFanTimer:
+      if (command.argument < tdTimer20 || command.argument > tdTimer240) return "Unknown timer";
+      addToEventLog(String("Fan switched on for ") + TIMER_TEXT[command.argument] + " by " + who(command));
+      setFanModeTimer((tTimerDuration)command.argument);
+      return fanStatus();
+
+    case cmClockOnShift:
+    case cmClockOffShift:
+      return shiftClock(command);
+
+    case cmStatus:
+      return fanStatus();
+    case cmInfo:
+      return info();
+    case cmHealth:
+      if (command.argument >= 0 && command.argument < MT_COUNT) return metricsHistory((metric_t)command.argument);
+      return metricsSummary();
+    case cmJobs:
+      return schedulerReport();
+    case cmPower:
+      return powerReport();
+    case cmPerf:
+      return perfReport();
+
+    case cmEventLog:
+      addToEventLog(String("Event log requested by ") + who(command));
+      return getEventLogAsString();
+    case cmEventLogClear:
+      clearEventLog();
+      addToEventLog(String("Event log cleared by ") + who(command));
+      return "Event log cleared\n";
+
+    default:
+      return "Command not recognized";
+  }
+}
+
+// ======== PUBLIC API ================
+void setupCommandBus() {
+  busJob = addDeadlineJob("commands", runCommands, jpRelay, 200);
+}
+
+bool postCommand(const Command &command) {
+  Queued entry = { command, nextSequence++ };
+
+  if (queued == MAX_QUEUED) {
+    size_t worst = leastUrgent();
+    if (!before(entry, queue[worst])) return false;
+
+    Command dropped = take(worst);
+    addToEventLog(String("Command queue full, dropped a command of ") + who(dropped));
+    if (dropped.reply) dropped.reply(dropped, "Dropped, the command queue is full");
+  }
+
+  queue[queued++] = entry;
+  if (busJob != NO_JOB) scheduleJob(busJob, 0);
+  return true;
+}
+
+void runCommands() {
+  while (queued > 0) {
+    Command command = take(mostUrgent());
+    String result = execute(command);
+    if (command.reply) command.reply(command, result);
+  }
+}
+
+commandPriority_t commandPriority(command_t command) {
+  return command < CM_COUNT ? PRIORITIES[command] : cpLogDump;
+}
+
+const char *originName(commandOrigin_t origin) {
+  return ORIGIN_NAMES[origin];
+}
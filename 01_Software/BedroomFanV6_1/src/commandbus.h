@@ -0,0 +1,61 @@
+#pragma once
+
+#include <Arduino.h>
+
+/*
+Command bus shared by the front ends.
+
+Telegram, the serial console and later the network translate their input
+into a Command and post it. The bus keeps a small queue ordered by
+priority: relay commands first, then settings, diagnostics and log dumps
+last. A deadline job executes the queue, so a relay command posted while
+a log dump waits runs first. A front end that answers within its own job
+posts and then calls runCommands() itself.
+
+Each command carries its origin and user, the event log names both. The
+result text goes to the reply function of the command, with the reply
+address the front end put in it.
+*/
+
+// ======== TYPES ================
+enum command_t {
+  // Relay
+  cmFanOn, cmFanOff, cmFanClock,
+  cmFanTimer,       // Argument: tTimerDuration
+  // Settings
+  cmClockOnShift,   // Argument: minutes
+  cmClockOffShift,  // Argument: minutes
+  // Diagnostics
+  cmStatus, cmInfo,
+  cmHealth,         // Argument: metric_t, or -1 for the summary
+  cmJobs, cmPower, cmPerf,
+  // Log dumps
+  cmEventLog, cmEventLogClear,
+  CM_COUNT
+};
+
+enum commandPriority_t { cpRelay, cpSettings, cpDiagnostics, cpLogDump };
+
+enum commandOrigin_t { coTelegram, coSerial, coNetwork };
+
+struct Command;
+typedef void (*commandReply_t)(const Command &command, const String &result);
+
+struct Command {
+  command_t       type = cmStatus;
+  int32_t         argument = 0;
+  commandOrigin_t origin = coSerial;
+  String          user;               // Who asked, for the event log
+  int64_t         replyTo = 0;        // Chat id or other address of the front end
+  int64_t         arrivedUs = 0;      // halMicros() when the front end received it, 0 if not known
+  commandReply_t  reply = nullptr;    // nullptr to discard the result
+};
+
+// ======== FUNCTIONS ================
+void setupCommandBus();
+
+bool postCommand(const Command &command); // false if the queue is full of commands at least as urgent
+void runCommands();                       // Execute the queue now, most urgent first
+
+commandPriority_t commandPriority(command_t command);
+const char *originName(commandOrigin_t origin);
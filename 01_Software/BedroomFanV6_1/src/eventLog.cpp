@@ -1,35 +1,49 @@
-#include "eventLog.h"
+#include "eventlog.h"
 #include <time.h>
+#include <utility>
+
+#include "localclock.h"
+#include "timefmt.h"
+
+// Entries start with "YYYY-MM-DD HH:MM:SS - "
+constexpr size_t TEXT_OFFSET = 22;
+
+// Of each entry, for eventLogRecord()
+struct RecordInfo {
+  uint32_t sequence;
+  time_t   when;
+};
 
 // Ring buffer
 static String eventLog[EVENTLOG_SIZE];
+static RecordInfo records[EVENTLOG_SIZE];
 static size_t writeIndex = 0;
 static size_t eventCount = 0;
+static uint32_t nextSequence = 0;
+
+static String stash[EVENTLOG_SIZE];
+static RecordInfo stashRecords[EVENTLOG_SIZE];
+static size_t stashWriteIndex = 0;
+static size_t stashCount = 0;
+static uint32_t stashNextSequence = 0;
 
 // Format timestamp: YYYY-MM-DD HH:MM:SS
-static String timeStamp() {
-  time_t now;
+static TimestampText timeStamp(time_t now) {
   struct tm timeinfo;
-  char buf[24];
-
-  time(&now);
-  localtime_r(&now, &timeinfo);
-
-  snprintf(buf, sizeof(buf),
-           "%04d-%02d-%02d %02d:%02d:%02d",
-           1900 + timeinfo.tm_year,
-           1 + timeinfo.tm_mon,
-           timeinfo.tm_mday,
-           timeinfo.tm_hour,
-           timeinfo.tm_min,
-           timeinfo.tm_sec);
 
-  return String(buf);
+  localClockAt(now, &timeinfo);
+  return formatTimestamp(timeinfo);
 }
 
 void addToEventLog(const String& event) {
-  // Compose entry (bounded)
-  eventLog[writeIndex] = timeStamp() + " - " + event;
+  time_t now = localClockNow();
+
+  // Compose entry in place, the slot keeps its buffer from the previous round
+  String &entry = eventLog[writeIndex];
+  entry = timeStamp(now).c_str();
+  entry += " - ";
+  entry += event;
+  records[writeIndex] = { nextSequence++, now };
 
   writeIndex = (writeIndex + 1) % EVENTLOG_SIZE;
   if (eventCount < EVENTLOG_SIZE) {
@@ -72,3 +86,45 @@ void clearEventLog() {
   writeIndex = 0;
   eventCount = 0;
 }
+
+uint32_t eventLogNextSequence() {
+  return nextSequence;
+}
+
+bool eventLogRecord(uint32_t sequence, time_t &when, const char *&text) {
+  // Slots hold the last EVENTLOG_SIZE sequence numbers, newest before writeIndex
+  uint32_t age = nextSequence - sequence;
+  if (age == 0 || age > eventCount) return false;
+
+  size_t index = (writeIndex + EVENTLOG_SIZE - age) % EVENTLOG_SIZE;
+  if (records[index].sequence != sequence) return false;
+
+  when = records[index].when;
+  text = eventLog[index].c_str() + TEXT_OFFSET;
+  return true;
+}
+
+// The sequence numbers continue after the benchmark, as if it never logged
+void stashEventLog() {
+  for (size_t i = 0; i < EVENTLOG_SIZE; i++) {
+    std::swap(stash[i], eventLog[i]);
+    std::swap(stashRecords[i], records[i]);
+    eventLog[i].clear();
+  }
+  stashWriteIndex = writeIndex;
+  stashCount = eventCount;
+  stashNextSequence = nextSequence;
+  writeIndex = 0;
+  eventCount = 0;
+}
+
+void unstashEventLog() {
+  for (size_t i = 0; i < EVENTLOG_SIZE; i++) {
+    std::swap(stash[i], eventLog[i]);
+    std::swap(stashRecords[i], records[i]);
+    stash[i].clear();
+  }
+  writeIndex = stashWriteIndex;
+  eventCount = stashCount;
+  nextSequence = stashNextSequence;
+}
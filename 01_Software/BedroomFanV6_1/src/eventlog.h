@@ -1,6 +1,7 @@
 #pragma once
 
 #include <Arduino.h>
+#include <time.h>
 
 constexpr size_t EVENTLOG_SIZE = 20;
 
@@ -8,3 +9,12 @@ void addToEventLog(const String& event);
 void addToEventLogf(const char *fmt, ...);
 String getEventLogAsString();
 void clearEventLog();
+
+// Every record gets the next sequence number, also across clearEventLog().
+// A record can be read back by it until the ring overwrites or clears it.
+uint32_t eventLogNextSequence();
+bool eventLogRecord(uint32_t sequence, time_t &when, const char *&text); // text without the timestamp
+
+// Keep the log aside while a benchmark fills it, without copying the entries
+void stashEventLog();
+void unstashEventLog();
@@ -1,9 +1,15 @@
-#include "fanControl.h"
-#include "esp_system.h"
+#include "fancontrol.h"
 #include <list>
 #include <string>
 #include "timer.h"
-#include "eventLog.h"
+#include "eventlog.h"
+#include "rtcstate.h"
+#include "settings.h"
+#include "power.h"
+#include "scheduler.h"
+#include "trace.h"
+#include "hal.h"
+#include "localclock.h"
 
 using namespace std;
 
@@ -14,6 +20,9 @@ const bool C_OFF = HIGH;
 
 // ======== GLOBALS ================
 bool fan_on = true;
+uint32_t fanOnSince = 0;        // halMillis() when the fan was last switched on
+uint64_t fanOnTotal = 0;        // Accumulated on-time in ms of earlier on periods
+uint32_t fanSwitches = 0;       // Changes of the relay state since boot
 tFanMode fanMode = fsClock;
 tTimerDuration timerDuration  = tdTimer20;
 milliSecTimer fanTimer = milliSecTimer(20*60*1000, false);
@@ -21,29 +30,76 @@ milliSecTimer fanTimer = milliSecTimer(20*60*1000, false);
 TimeOfDay clock_on (16, 30);
 TimeOfDay clock_off(22, 00);
 
+static job_t fanJob = NO_JOB;
+
 // ======== FUNCTIONS ================
+// Persist the new state and re-evaluate the fan right away
+static void fanStateChanged() {
+  saveStateSnapshot();
+  markSettingsDirty(true);
+  scheduleJob(fanJob, 0);
+}
+
+// Time in ms until loopFan() has something to do
+static uint32_t fanNextDeadline() {
+  const uint32_t IDLE_CHECK = 1 * MS_PER_MIN;
+
+  switch (fanMode) {
+    case fsTimer:
+      if (!fanIsOn() || fanTimer.lapsed()) return IDLE_CHECK;
+      return fanTimer.remaining();
+    case fsClock: {
+      struct tm timeinfo;
+      if (!localClockTime(&timeinfo)) return 1 * MS_PER_SEC; // Wait for a time source
+      return (60 - timeinfo.tm_sec) * MS_PER_SEC;             // Next minute boundary
+    }
+    default:
+      return IDLE_CHECK;
+  }
+}
+
+static void runFanJob() {
+  loopFan();
+  scheduleJob(fanJob, fanNextDeadline());
+}
+
 void switchOnFan() {
+  PowerLock lock(plRelay);
+  if (!fan_on) {
+    fanOnSince = halMillis();
+    fanSwitches++;
+  }
   fan_on = true;
-  digitalWrite(RELAY_PIN, C_ON);
+  halDigitalWrite(RELAY_PIN, C_ON);
+  traceStamp(trRelay);
 }
 
 void switchOffFan() {
+  PowerLock lock(plRelay);
+  if (fan_on) {
+    fanOnTotal += halMillis() - fanOnSince;
+    fanSwitches++;
+  }
   fan_on = false;
-  digitalWrite(RELAY_PIN, C_OFF);
+  halDigitalWrite(RELAY_PIN, C_OFF);
+  traceStamp(trRelay);
 }
 
 void setFanModeOn() {
   fanMode = fsOn;
   switchOnFan();
+  fanStateChanged();
 }
 
 void setFanModeOff() {
   fanMode = fsOff;
   switchOffFan();
+  fanStateChanged();
 }
 
 void setFanModeClock() {
   fanMode = fsClock;
+  fanStateChanged();
 }
 
 void setFanModeTimer(tTimerDuration duration) {
@@ -58,6 +114,28 @@ void setFanModeTimer(tTimerDuration duration) {
   timerDuration = duration;
   fanMode = fsTimer;
   switchOnFan();
+  fanStateChanged();
+}
+
+const char *fanModeName() {
+  static const char *TIMER_MODES[] = { "timer20", "timer60", "timer240" };
+
+  switch (fanMode) {
+    case fsOn:    return "on";
+    case fsOff:   return "off";
+    case fsClock: return "clock";
+    case fsTimer: return TIMER_MODES[timerDuration];
+  }
+  return "";
+}
+
+uint32_t fanTimerMinutes() {
+  if (fanMode != fsTimer || !fanIsOn()) return 0;
+  return (fanTimer.remaining() + MS_PER_MIN - 1) / MS_PER_MIN;
+}
+
+void clockWindowChanged() {
+  scheduleJob(fanJob, 0);
 }
 
 void setFanClockMode() {
@@ -65,21 +143,38 @@ void setFanClockMode() {
 }
 
 void setupFan() {
-  pinMode(RELAY_PIN, OUTPUT);
-  setFanModeClock();
+  // Set the level before enabling the output, so the relay does not toggle
+  halDigitalWrite(RELAY_PIN, fan_on ? C_ON : C_OFF);
+  halPinMode(RELAY_PIN, OUTPUT);
+
+  // Resume where we were: RTC memory after a soft reset, NVS after power on
+  bool haveSettings = loadSettings();
+  if (restoreStateSnapshot()) {
+    addToEventLog("Fan state restored after reset");
+  } else if (haveSettings) {
+    applySettings();
+    addToEventLog("Fan settings restored from NVS");
+  } else {
+    setFanModeClock();
+  }
   loopFan(); // check initial state
+
+  // Runs at the next timer expiry or minute boundary, and after every mode change
+  fanJob = addDeadlineJob("fan", runFanJob, jpRelay, 5);
+  scheduleJob(fanJob, fanNextDeadline());
 }
 
 void loopFan() {
 
-  if (fanMode == fsTimer && fanTimer.lapsed()) {
+  if (fanMode == fsTimer && fanIsOn() && fanTimer.lapsed()) {
     switchOffFan();
+    fanStateChanged();
     addToEventLog("Timer lapsed. Fan switching off");
   }
 
   if (fanMode == fsClock) {
     struct tm timeinfo;
-    if (!getLocalTime(&timeinfo)) return;
+    if (!localClockTime(&timeinfo)) return; // Do not wait for a clock that is not set yet
 
     bool fan_must_be_on =
       clock_on.is_due(timeinfo.tm_hour, timeinfo.tm_min) &&
@@ -99,4 +194,14 @@ void loopFan() {
 
 bool fanIsOn() {
   return fan_on;
-}
\ No newline at end of file
+}
+
+uint32_t fanOnSeconds() {
+  uint64_t total = fanOnTotal;
+  if (fan_on) total += halMillis() - fanOnSince;
+  return total / 1000;
+}
+
+uint32_t fanSwitchCount() {
+  return fanSwitches;
+}
@@ -2,7 +2,6 @@
 
 #include <Arduino.h>
 #include "time.h"
-#include <WiFi.h>
 
 #include "clock.h"
 #include "timer.h"
@@ -28,11 +27,16 @@ extern TimeOfDay clock_off;
 void switchOnFan();  // Switch on fan, do not change mode
 void switchOffFan(); // Switch off fan, do not change mode
 bool fanIsOn();      // Return true if fan is currently on
+uint32_t fanOnSeconds(); // Total seconds the fan was on since boot
+uint32_t fanSwitchCount(); // Changes of the relay state since boot
+const char *fanModeName(); // on, off, clock, timer20, timer60 or timer240
+uint32_t fanTimerMinutes(); // Minutes until the timer switches off, rounded up, 0 without timer
 
 void setFanModeOn();
 void setFanModeOff();
 void setFanModeClock();
 void setFanModeTimer(tTimerDuration duration);
+void clockWindowChanged(); // Re-evaluate the fan after clock_on or clock_off was edited
 
 void setupFan();
 void loopFan();
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+/*
+Hardware abstraction layer.
+
+The fan control, clock, event log and Telegram handlers reach the hardware
+through these functions only, so they build unchanged for the board and for
+a Linux host. hal_esp32.cpp implements them with the Arduino and ESP-IDF
+API, native/hal_linux.cpp with the Linux clocks and a simulated relay pin
+and WiFi link. The TCP connections and UDP datagrams are real sockets on
+both, so the MQTT client, the HTTP server and the remote log can be tried on
+Linux against real peers.
+
+The Bot API transport is CTBot itself: on the host, native/CTBot.h provides
+the same class on top of a BotTransport (native/bot_transport.h).
+*/
+
+// ======== GPIO ================
+void halPinMode(uint8_t pin, uint8_t mode);
+void halDigitalWrite(uint8_t pin, uint8_t level);
+int  halDigitalRead(uint8_t pin);
+
+// ======== CLOCKS ================
+uint32_t halMillis();                  // Monotonic, wraps after 49 days like millis()
+int64_t  halMicros();                  // Monotonic, does not wrap
+void     halDelay(uint32_t ms);        // Idle, the CPU may sleep
+bool     halNetWait(uint32_t ms);      // Like halDelay(), but true as soon as the TCP client or server has input
+
+time_t halTime();                      // Wall clock, seconds since the epoch
+void   halSetTime(time_t epoch);
+bool   halLocalTime(struct tm *info);  // Local time, false while the wall clock is not set
+
+uint32_t halCycleCount();              // For short measurements, wraps; the host counts nanoseconds
+uint32_t halCycleHz();                 // Rate of halCycleCount()
+
+// ======== WIFI ================
+bool   halWifiConnected();
+int8_t halWifiRssi();                  // [dBm]
+
+// ======== TCP ================
+// One client connection. Only the connect waits, up to timeoutMs.
+bool halTcpConnect(const char *host, uint16_t port, uint32_t timeoutMs);
+bool halTcpConnected();
+int  halTcpRead(uint8_t *buffer, size_t size);        // Bytes read, 0 if none waiting, -1 when closed
+bool halTcpWrite(const uint8_t *data, size_t length); // false if the connection failed
+void halTcpClose();
+
+// ======== TCP SERVER ================
+// Accepted connections are numbered 0 to HAL_MAX_CONNECTIONS - 1. Nothing
+// waits, a write takes what fits in the socket buffer.
+constexpr int HAL_MAX_CONNECTIONS = 4;
+
+bool halServerBegin(uint16_t port);
+int  halServerAccept();                                          // Connection number, -1 if none waiting
+int  halConnRead(int conn, uint8_t *buffer, size_t size);        // Like halTcpRead()
+int  halConnWrite(int conn, const uint8_t *data, size_t length); // Bytes taken, 0 if the buffer is full, -1 if failed
+void halConnClose(int conn);
+
+void halAdvertise(const char *hostname, const char *service, uint16_t port); // mDNS <hostname>.local
+
+// ======== UDP ================
+// Datagrams to one destination. A send never waits, it fails while the
+// network stack has no room for the datagram.
+bool halUdpBegin(const char *host, uint16_t port);   // Resolves the host, may wait for DNS
+bool halUdpSend(const uint8_t *data, size_t length); // false if the datagram was not taken
@@ -0,0 +1,205 @@
+#include "hal.h"
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <WiFiUdp.h>
+#include <ESPmDNS.h>
+#include <esp_timer.h>
+#include <lwip/sockets.h>
+#include <errno.h>
+#include <sys/time.h>
+
+// ======== GPIO ======================
+void halPinMode(uint8_t pin, uint8_t mode) {
+  pinMode(pin, mode);
+}
+
+void halDigitalWrite(uint8_t pin, uint8_t level) {
+  digitalWrite(pin, level);
+}
+
+int halDigitalRead(uint8_t pin) {
+  return digitalRead(pin);
+}
+
+// ======== CLOCKS ====================
+uint32_t halMillis() {
+  return millis();
+}
+
+int64_t halMicros() {
+  return esp_timer_get_time();
+}
+
+void halDelay(uint32_t ms) {
+  delay(ms);
+}
+
+time_t halTime() {
+  return time(nullptr);
+}
+
+void halSetTime(time_t epoch) {
+  struct timeval tv = { epoch, 0 };
+  settimeofday(&tv, nullptr);
+}
+
+bool halLocalTime(struct tm *info) {
+  return getLocalTime(info, 0); // Do not wait for a clock that is not set yet
+}
+
+// Only steady while a PowerLock keeps the CPU at full speed, see power.h
+uint32_t halCycleCount() {
+  return ESP.getCycleCount();
+}
+
+uint32_t halCycleHz() {
+  return ESP.getCpuFreqMHz() * 1000000;
+}
+
+// ======== WIFI ======================
+bool halWifiConnected() {
+  return WiFi.status() == WL_CONNECTED;
+}
+
+int8_t halWifiRssi() {
+  return WiFi.RSSI();
+}
+
+// ======== TCP =======================
+static WiFiClient tcpClient;
+
+bool halTcpConnect(const char *host, uint16_t port, uint32_t timeoutMs) {
+  tcpClient.stop();
+  if (!tcpClient.connect(host, port, timeoutMs)) return false;
+  tcpClient.setNoDelay(true); // Small packets that should leave at once
+  return true;
+}
+
+bool halTcpConnected() {
+  return tcpClient.connected();
+}
+
+int halTcpRead(uint8_t *buffer, size_t size) {
+  int available = tcpClient.available();
+  if (available <= 0) return tcpClient.connected() ? 0 : -1;
+  return tcpClient.read(buffer, min((size_t)available, size));
+}
+
+bool halTcpWrite(const uint8_t *data, size_t length) {
+  return tcpClient.write(data, length) == length;
+}
+
+void halTcpClose() {
+  tcpClient.stop();
+}
+
+// ======== TCP SERVER ================
+// lwIP sockets rather than WiFiServer, whose writes wait for buffer space
+static int listenSocket = -1;
+static int connSockets[HAL_MAX_CONNECTIONS] = { -1, -1, -1, -1 };
+
+bool halServerBegin(uint16_t port) {
+  listenSocket = socket(AF_INET, SOCK_STREAM, 0);
+  if (listenSocket < 0) return false;
+  int one = 1;
+  setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+  struct sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = INADDR_ANY;
+  address.sin_port = htons(port);
+  if (bind(listenSocket, (struct sockaddr *)&address, sizeof(address)) != 0 || listen(listenSocket, 4) != 0) {
+    close(listenSocket);
+    listenSocket = -1;
+    return false;
+  }
+  fcntl(listenSocket, F_SETFL, O_NONBLOCK);
+  return true;
+}
+
+int halServerAccept() {
+  if (listenSocket < 0) return -1;
+  int fd = accept(listenSocket, nullptr, nullptr);
+  if (fd < 0) return -1;
+
+  for (int conn = 0; conn < HAL_MAX_CONNECTIONS; conn++) {
+    if (connSockets[conn] < 0) {
+      int one = 1;
+      fcntl(fd, F_SETFL, O_NONBLOCK);
+      setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+      connSockets[conn] = fd;
+      return conn;
+    }
+  }
+  close(fd); // All slots busy
+  return -1;
+}
+
+int halConnRead(int conn, uint8_t *buffer, size_t size) {
+  if (connSockets[conn] < 0) return -1;
+  int n = recv(connSockets[conn], buffer, size, MSG_DONTWAIT);
+  if (n > 0) return n;
+  if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) return 0;
+  return -1;
+}
+
+int halConnWrite(int conn, const uint8_t *data, size_t length) {
+  if (connSockets[conn] < 0) return -1;
+  int n = send(connSockets[conn], data, length, MSG_DONTWAIT);
+  if (n >= 0) return n;
+  if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) return 0;
+  return -1;
+}
+
+void halConnClose(int conn) {
+  if (connSockets[conn] >= 0) close(connSockets[conn]);
+  connSockets[conn] = -1;
+}
+
+void halAdvertise(const char *hostname, const char *service, uint16_t port) {
+  if (MDNS.begin(hostname)) MDNS.addService(service, "tcp", port);
+}
+
+// ======== NETWORK WAIT ============
+static void watch(fd_set &set, int &highest, int fd) {
+  if (fd < 0) return;
+  FD_SET(fd, &set);
+  highest = max(highest, fd);
+}
+
+// select() blocks the task like delay(), the idle task may still sleep
+bool halNetWait(uint32_t ms) {
+  fd_set readable;
+  FD_ZERO(&readable);
+  int highest = -1;
+  if (tcpClient.connected()) watch(readable, highest, tcpClient.fd());
+  watch(readable, highest, listenSocket);
+  for (int fd : connSockets) watch(readable, highest, fd);
+
+  if (highest < 0) {
+    delay(ms);
+    return false;
+  }
+  struct timeval timeout = { (time_t)(ms / 1000), (suseconds_t)(ms % 1000 * 1000) };
+  return select(highest + 1, &readable, nullptr, nullptr, &timeout) > 0;
+}
+
+// ======== UDP =======================
+// WiFiUDP makes its socket non-blocking
+static WiFiUDP udp;
+static IPAddress udpAddress;
+static uint16_t udpPort = 0;
+
+bool halUdpBegin(const char *host, uint16_t port) {
+  udpPort = 0;
+  if (!WiFi.hostByName(host, udpAddress)) return false;
+  udpPort = port;
+  return true;
+}
+
+bool halUdpSend(const uint8_t *data, size_t length) {
+  if (udpPort == 0 || !udp.beginPacket(udpAddress, udpPort)) return false;
+  udp.write(data, length);
+  return udp.endPacket() == 1;
+}
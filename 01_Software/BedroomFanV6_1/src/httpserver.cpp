@@ -0,0 +1,402 @@
+#include "httpserver.h"
+
+#include <string.h>
+#include <strings.h>
+#include <stdlib.h>
+
+#include "commandbus.h"
+#include "fancontrol.h"
+#include "scheduler.h"
+#include "perf.h"
+#include "timefmt.h"
+#include "wifi_connect.h"
+#include "hal.h"
+#include "statuspage.h"
+#include "prometheus.h"
+
+// ======== CONSTANTS =================
+constexpr uint16_t PORT         = 80;
+constexpr uint32_t POLL_PERIOD  = 5;                 // [ms] Only while a connection is open
+constexpr uint32_t WIFI_CHECK   = 1 * MS_PER_SEC;    // Until mDNS is advertised
+constexpr uint32_t IDLE_TIMEOUT = 3 * MS_PER_SEC;    // For the whole request, then between writes
+
+constexpr size_t REQUEST_SIZE = 512;
+constexpr size_t HEAD_SIZE    = 256;
+constexpr size_t BODY_SIZE    = 3072;                // The full event log fits
+
+static const char *HOSTNAME = "bedroomfan";
+static const char *USER     = "http";
+
+static const char *JSON = "application/json";
+static const char *TEXT = "text/plain; charset=utf-8";
+static const char *PROMETHEUS = "text/plain; version=0.0.4; charset=utf-8";
+
+// ======== TYPES =====================
+enum reply_t { rpStatus, rpText };
+
+// Renders the next part of a streamed response into out, 0 at the end
+typedef size_t (*render_t)(char *out, size_t size, uint32_t &cursor);
+
+// Endpoints that run one command of the bus
+struct Route {
+  const char *method;
+  const char *path;
+  command_t   command;
+  int32_t     argument;
+  reply_t     reply;    // The new status, or the result of the command
+};
+
+static const Route ROUTES[] = {
+  { "POST",   "/api/fan/on",        cmFanOn,         0,          rpStatus },
+  { "POST",   "/api/fan/off",       cmFanOff,        0,          rpStatus },
+  { "POST",   "/api/fan/clock",     cmFanClock,      0,          rpStatus },
+  { "POST",   "/api/fan/timer/20",  cmFanTimer,      tdTimer20,  rpStatus },
+  { "POST",   "/api/fan/timer/60",  cmFanTimer,      tdTimer60,  rpStatus },
+  { "POST",   "/api/fan/timer/240", cmFanTimer,      tdTimer240, rpStatus },
+  { "POST",   "/api/clock/on",      cmClockOnShift,  0,          rpStatus }, // Argument from ?shift=
+  { "POST",   "/api/clock/off",     cmClockOffShift, 0,          rpStatus },
+  { "GET",    "/api/info",          cmInfo,          0,          rpText   },
+  { "GET",    "/api/health",        cmHealth,        -1,         rpText   },
+  { "GET",    "/api/jobs",          cmJobs,          0,          rpText   },
+  { "GET",    "/api/power",         cmPower,         0,          rpText   },
+  { "GET",    "/api/perf",          cmPerf,          0,          rpText   },
+  { "GET",    "/api/eventlog",      cmEventLog,      0,          rpText   },
+  { "DELETE", "/api/eventlog",      cmEventLogClear, 0,          rpText   },
+};
+
+struct Connection {
+  bool     open = false;
+  uint32_t activeMs = 0;     // Accepted, or last bytes of the response taken
+  int64_t  startUs = 0;
+
+  char   request[REQUEST_SIZE + 1];
+  size_t requestLength = 0;
+
+  char           head[HEAD_SIZE];
+  size_t         headLength = 0;
+  char           body[BODY_SIZE];
+  const uint8_t *content = nullptr;   // body, or the page in flash
+  size_t         contentLength = 0;
+  size_t         sent = 0;            // Of head and content
+  bool           responding = false;
+  render_t       render = nullptr;    // Refills body for a streamed response
+  uint32_t       cursor = 0;
+};
+
+// ======== STATE =====================
+static Connection conns[HAL_MAX_CONNECTIONS];
+static bool listening = false;
+static bool advertised = false;
+static job_t httpJob = NO_JOB;
+static perf_t perfRequest = NO_PERF;
+
+// ======== HELPERS ===================
+static const char *reason(int status) {
+  switch (status) {
+    case 200: return "OK";
+    case 304: return "Not Modified";
+    case 400: return "Bad Request";
+    case 404: return "Not Found";
+    case 403: return "Forbidden";
+    case 405: return "Method Not Allowed";
+    case 431: return "Request Header Fields Too Large";
+    case 503: return "Service Unavailable";
+    default:  return "";
+  }
+}
+
+static void respond(Connection &c, int status, const char *contentType, const uint8_t *content, size_t length,
+                    const char *extraHeaders = "") {
+  c.headLength = snprintf(c.head, HEAD_SIZE,
+                          "HTTP/1.1 %d %s\r\nContent-Type: %s\r\nContent-Length: %u\r\nConnection: close\r\n%s\r\n",
+                          status, reason(status), contentType, (unsigned)length, extraHeaders);
+  c.content = content;
+  c.contentLength = length;
+  c.sent = 0;
+  c.responding = true;
+  c.render = nullptr;
+}
+
+// Without a length, the end of the response is the close of the connection
+static void respondStream(Connection &c, const char *contentType, render_t render) {
+  c.headLength = snprintf(c.head, HEAD_SIZE, "HTTP/1.1 200 OK\r\nContent-Type: %s\r\nConnection: close\r\n\r\n",
+                          contentType);
+  c.cursor = 0;
+  c.content = (const uint8_t *)c.body;
+  c.contentLength = render(c.body, BODY_SIZE, c.cursor);
+  c.sent = 0;
+  c.responding = true;
+  c.render = render;
+}
+
+static void respondBody(Connection &c, int status, const char *contentType, size_t length) {
+  respond(c, status, contentType, (const uint8_t *)c.body, min(length, BODY_SIZE - 1));
+}
+
+static void respondError(Connection &c, int status) {
+  size_t length = snprintf(c.body, BODY_SIZE, "{\"error\":\"%s\"}\n", reason(status));
+  respondBody(c, status, JSON, length);
+}
+
+static size_t statusJson(char *out, size_t size) {
+  return snprintf(out, size,
+                  "{\"relay\":\"%s\",\"mode\":\"%s\",\"clock_on\":\"%s\",\"clock_off\":\"%s\",\"timer_remaining\":%u}\n",
+                  fanIsOn() ? "ON" : "OFF", fanModeName(),
+                  formatClock(clock_on.minutes_after_midnight).c_str(),
+                  formatClock(clock_off.minutes_after_midnight).c_str(), fanTimerMinutes());
+}
+
+// Value of a request header, nullptr if it is missing. Ends at \r.
+static const char *header(const char *request, const char *name) {
+  size_t length = strlen(name);
+  for (const char *line = strstr(request, "\r\n"); line != nullptr; line = strstr(line, "\r\n")) {
+    line += 2;
+    if (strncasecmp(line, name, length) == 0 && line[length] == ':') {
+      line += length + 1;
+      while (*line == ' ') line++;
+      return line;
+    }
+  }
+  return nullptr;
+}
+
+static bool queryInt(const char *query, const char *name, int32_t &value) {
+  size_t length = strlen(name);
+  for (const char *p = query; p != nullptr && *p; p = strchr(p, '&')) {
+    if (*p == '&') p++;
+    if (strncmp(p, name, length) == 0 && p[length] == '=') {
+      value = atoi(p + length + 1);
+      return true;
+    }
+  }
+  return false;
+}
+
+// The bus ran the command of a connection, replyTo is its number
+static void keepResult(const Command &command, const String &result) {
+  Connection &c = conns[command.replyTo];
+  c.contentLength = min((size_t)result.length(), BODY_SIZE - 1);
+  memcpy(c.body, result.c_str(), c.contentLength);
+}
+
+// Names a browser reaches the device by. A page of another site that its
+// DNS points at the device still has its own name in Host.
+static bool ownHost(const char *host) {
+  if (host[0] == '[') return true; // IPv6 address
+
+  size_t length = strcspn(host, ":\r");
+  size_t nameLength = strlen(HOSTNAME);
+  if (length == nameLength + 6 && strncasecmp(host, HOSTNAME, nameLength) == 0 &&
+      strncasecmp(host + nameLength, ".local", 6) == 0) return true;
+  if (length == 9 && strncasecmp(host, "localhost", 9) == 0) return true;
+
+  for (size_t i = 0; i < length; i++) if (!isdigit(host[i]) && host[i] != '.') return false;
+  return length > 0; // IPv4 address
+}
+
+// A browser sends Origin with every cross-site POST and DELETE. Without it
+// the request comes from a script or curl, which may change the fan.
+static bool sameOrigin(const char *request) {
+  const char *origin = header(request, "Origin");
+  if (origin == nullptr) return true;
+
+  const char *host = header(request, "Host");
+  if (host == nullptr) return false;
+  size_t hostLength = strcspn(host, "\r");
+  size_t originLength = strcspn(origin, "\r");
+
+  return ownHost(host) && originLength == hostLength + 7 &&
+         strncmp(origin, "http://", 7) == 0 && strncasecmp(origin + 7, host, hostLength) == 0;
+}
+
+static void runRoute(int index, const Route &route, const char *query) {
+  Connection &c = conns[index];
+
+  if (strcmp(route.method, "GET") != 0 && !sameOrigin(c.request)) return respondError(c, 403);
+
+  Command command;
+  command.type     = route.command;
+  command.argument = route.argument;
+  command.origin   = coNetwork;
+  command.user     = USER;
+  command.replyTo  = index;
+  command.reply    = keepResult;
+
+  if (route.command == cmClockOnShift || route.command == cmClockOffShift) {
+    if (!queryInt(query, "shift", command.argument)) return respondError(c, 400);
+  }
+
+  // Run it now, the response carries the result
+  if (!postCommand(command)) return respondError(c, 503);
+  runCommands();
+
+  if (route.reply == rpStatus) respondBody(c, 200, JSON, statusJson(c.body, BODY_SIZE));
+  else respondBody(c, 200, TEXT, c.contentLength);
+}
+
+static void servePage(Connection &c) {
+  static const char *HEADERS = "Content-Encoding: gzip\r\nCache-Control: no-cache\r\nETag: ";
+
+  const char *tag = header(c.request, "If-None-Match");
+  size_t tagLength = strlen(STATUS_PAGE_ETAG);
+  char extra[96];
+  snprintf(extra, sizeof(extra), "%s%s\r\n", HEADERS, STATUS_PAGE_ETAG);
+
+  if (tag && strncmp(tag, STATUS_PAGE_ETAG, tagLength) == 0 && (tag[tagLength] == '\r' || tag[tagLength] == '\0')) {
+    respond(c, 304, "text/html", nullptr, 0, extra);
+  } else {
+    respond(c, 200, "text/html", STATUS_PAGE_GZIP, STATUS_PAGE_SIZE, extra);
+  }
+}
+
+static void handleRequest(int index) {
+  Connection &c = conns[index];
+
+  // Request line: METHOD TARGET VERSION, split in a copy so header() still sees the request
+  char line[REQUEST_SIZE];
+  size_t lineLength = strcspn(c.request, "\r");
+  memcpy(line, c.request, lineLength);
+  line[lineLength] = '\0';
+
+  char *method = line;
+  char *path = strchr(method, ' ');
+  if (path == nullptr) return respondError(c, 400);
+  *path++ = '\0';
+  char *version = strchr(path, ' ');
+  if (version == nullptr) return respondError(c, 400);
+  *version = '\0';
+  char *query = strchr(path, '?');
+  if (query) *query++ = '\0';
+
+  if (strcmp(path, "/") == 0 || strcmp(path, "/index.html") == 0) {
+    if (strcmp(method, "GET") != 0) return respondError(c, 405);
+    return servePage(c);
+  }
+  if (strcmp(path, "/api/status") == 0) {
+    if (strcmp(method, "GET") != 0) return respondError(c, 405);
+    return respondBody(c, 200, JSON, statusJson(c.body, BODY_SIZE));
+  }
+  if (strcmp(path, "/metrics") == 0) {
+    if (strcmp(method, "GET") != 0) return respondError(c, 405);
+    return respondStream(c, PROMETHEUS, prometheusRender);
+  }
+
+  bool pathFound = false;
+  for (const Route &route : ROUTES) {
+    if (strcmp(path, route.path) != 0) continue;
+    pathFound = true;
+    if (strcmp(method, route.method) == 0) return runRoute(index, route, query);
+  }
+  respondError(c, pathFound ? 405 : 404);
+}
+
+static void closeConnection(int index) {
+  // Unread bytes would turn the close into a reset that can cut off the response
+  uint8_t rest[64];
+  while (halConnRead(index, rest, sizeof(rest)) > 0) {}
+
+  halConnClose(index);
+  conns[index].open = false;
+}
+
+// Input after the request is not used, read so it does not wake the scheduler again
+static void discardInput(int index) {
+  uint8_t rest[64];
+  int n;
+  while ((n = halConnRead(index, rest, sizeof(rest))) > 0) {}
+  if (n < 0) closeConnection(index);
+}
+
+static void receive(int index) {
+  Connection &c = conns[index];
+  int n = halConnRead(index, (uint8_t *)c.request + c.requestLength, REQUEST_SIZE - c.requestLength);
+  if (n < 0) return closeConnection(index);
+  if (n == 0) return;
+
+  c.requestLength += n;
+  c.request[c.requestLength] = '\0';
+  if (strstr(c.request, "\r\n\r\n")) handleRequest(index);
+  else if (c.requestLength == REQUEST_SIZE) respondError(c, 431);
+}
+
+static void transmit(int index) {
+  Connection &c = conns[index];
+  size_t total = c.headLength + c.contentLength;
+
+  while (true) {
+    if (c.sent == total) {
+      if (c.render == nullptr) break;
+
+      // The next part of a streamed response, in the same body
+      c.headLength = 0;
+      c.sent = 0;
+      c.contentLength = c.render(c.body, BODY_SIZE, c.cursor);
+      total = c.contentLength;
+      if (total == 0) break;
+    }
+
+    const uint8_t *data;
+    size_t length;
+    if (c.sent < c.headLength) {
+      data = (const uint8_t *)c.head + c.sent;
+      length = c.headLength - c.sent;
+    } else {
+      data = c.content + (c.sent - c.headLength);
+      length = total - c.sent;
+    }
+
+    int n = halConnWrite(index, data, length);
+    if (n < 0) return closeConnection(index);
+    if (n == 0) return; // Socket buffer full, continue in the next run
+    c.sent += n;
+    c.activeMs = halMillis(); // A long stream is not cut off while the client reads it
+  }
+
+  perfRecord(perfRequest, halMicros() - c.startUs);
+  closeConnection(index);
+}
+
+// ======== PUBLIC API ================
+void setupHttp() {
+  listening = halServerBegin(PORT);
+  if (!listening) return;
+
+  // Runs on network input, and polls only while connections are open
+  perfRequest = perfSection("http");
+  httpJob = addDeadlineJob("http", loopHttp, jpNetwork, 20);
+  wakeOnNetwork(httpJob);
+  scheduleJob(httpJob, 0);
+}
+
+void loopHttp() {
+  if (!advertised && wifiIsConnected()) {
+    halAdvertise(HOSTNAME, "http", PORT);
+    advertised = true;
+  }
+
+  int index;
+  while ((index = halServerAccept()) >= 0) {
+    Connection &c = conns[index];
+    c.open = true;
+    c.activeMs = halMillis();
+    c.startUs = halMicros();
+    c.requestLength = 0;
+    c.responding = false;
+    c.render = nullptr;
+  }
+
+  for (index = 0; index < HAL_MAX_CONNECTIONS; index++) {
+    Connection &c = conns[index];
+    if (!c.open) continue;
+
+    if (!c.responding) receive(index);
+    else discardInput(index);
+    if (c.open && c.responding) transmit(index);
+    if (c.open && halMillis() - c.activeMs >= IDLE_TIMEOUT) closeConnection(index);
+  }
+
+  bool open = false;
+  for (const Connection &c : conns) open = open || c.open;
+  if (open) scheduleJob(httpJob, POLL_PERIOD);
+  else if (!advertised) scheduleJob(httpJob, WIFI_CHECK);
+}
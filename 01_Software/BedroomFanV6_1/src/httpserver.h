@@ -0,0 +1,35 @@
+#pragma once
+
+#include <Arduino.h>
+
+/*
+HTTP server on the local network, found as bedroomfan.local.
+
+Works without the internet, unlike Telegram. The REST endpoints mirror the
+Telegram buttons and go through the same command bus:
+
+  GET    /                    status page, gzipped from flash, ETag cached
+  GET    /api/status          {"relay":"ON","mode":"clock",...}
+  POST   /api/fan/on | off | clock
+  POST   /api/fan/timer/20 | 60 | 240
+  POST   /api/clock/on?shift=-15, /api/clock/off?shift=60   [min]
+  GET    /api/info | health | jobs | power | perf
+  GET    /api/eventlog
+  DELETE /api/eventlog
+  GET    /metrics             Prometheus text format, see prometheus.h
+
+The POST endpoints answer with the new status. POST and DELETE from a
+browser page must come from the device's own origin, so other sites cannot
+switch the fan. The server job runs when the scheduler sees network input
+and polls only while a connection is open; reads and writes never wait.
+Each connection has fixed request and response buffers, one request per
+connection. tools/http_load.py measures the response times
+against the Linux build (program --http <port>).
+
+The page source is web/status.html, tools/embed_page.py turns it into
+statuspage.h.
+*/
+
+// ======== FUNCTIONS ================
+void setupHttp();
+void loopHttp();
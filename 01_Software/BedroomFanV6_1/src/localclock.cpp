@@ -0,0 +1,153 @@
+#include "localclock.h"
+
+#include <stdlib.h>
+
+#include "hal.h"
+
+// ======== CONSTANTS =================
+constexpr time_t CLOCK_VALID_AFTER = 1451606400;  // 2016-01-01, like getLocalTime()
+constexpr time_t SECONDS_PER_DAY   = 24 * 60 * 60;
+constexpr time_t SCAN_STEP         = 7 * SECONDS_PER_DAY; // DST periods last longer than a week
+constexpr int    SCAN_STEPS        = 60;                  // About a year each way
+
+// ======== STATE =====================
+struct LocalClock {
+  // DST period: the offset is valid for periodStart <= epoch < periodEnd
+  bool   periodValid = false;
+  time_t periodStart = 0;
+  time_t periodEnd = 0;
+  int32_t offset = 0;    // [s] Local time minus UTC
+  int    isDst = 0;
+
+  // Broken-down time of the last minute that was converted
+  time_t cachedMinute = -1; // Local epoch / 60
+  struct tm cachedTm = {};
+
+  bool   tickValid = false;
+  time_t tickNow = 0;
+
+  uint32_t lookups = 0;
+};
+
+static LocalClock lc;
+
+// ======== HELPERS ===================
+// Days since 1970-01-01 of a date in the proleptic Gregorian calendar
+static int64_t daysFromCivil(int64_t y, int m, int d) {
+  y -= m <= 2;
+  int64_t era = (y >= 0 ? y : y - 399) / 400;
+  int64_t yoe = y - era * 400;
+  int64_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+  int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + doe - 719468;
+}
+
+static void civilFromDays(int64_t days, int &y, int &m, int &d) {
+  days += 719468;
+  int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+  int64_t doe = days - era * 146097;
+  int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  int64_t mp = (5 * doy + 2) / 153;
+  d = doy - (153 * mp + 2) / 5 + 1;
+  m = mp < 10 ? mp + 3 : mp - 9;
+  y = yoe + era * 400 + (m <= 2);
+}
+
+// Offset of local time from UTC at a moment, the slow way
+static int32_t offsetAt(time_t epoch, int *isDst = nullptr) {
+  struct tm t;
+  localtime_r(&epoch, &t);
+  if (isDst) *isDst = t.tm_isdst;
+  int64_t local = daysFromCivil(1900 + t.tm_year, t.tm_mon + 1, t.tm_mday) * SECONDS_PER_DAY +
+                  t.tm_hour * 3600 + t.tm_min * 60 + t.tm_sec;
+  return local - epoch;
+}
+
+// First moment after from where the offset differs, from + step * SCAN_STEPS if there is none
+static time_t findTransition(time_t from, time_t step, int32_t offset) {
+  time_t same = from;
+  for (int i = 0; i < SCAN_STEPS; i++) {
+    time_t next = same + step;
+    if (offsetAt(next) != offset) {
+      // Bisect down to the second
+      time_t other = next;
+      while (other - same > 1 || same - other > 1) {
+        time_t mid = same + (other - same) / 2;
+        if (offsetAt(mid) == offset) same = mid;
+        else other = mid;
+      }
+      return other;
+    }
+    same = next;
+  }
+  return same;
+}
+
+static void lookupPeriod(time_t epoch) {
+  lc.lookups++;
+  lc.offset = offsetAt(epoch, &lc.isDst);
+  lc.periodEnd = findTransition(epoch, SCAN_STEP, lc.offset);
+  lc.periodStart = findTransition(epoch, -SCAN_STEP, lc.offset) + 1;
+  lc.periodValid = true;
+  lc.cachedMinute = -1;
+}
+
+// ======== PUBLIC API ================
+void localClockSetZone(const char *tz) {
+  setenv("TZ", tz, 1);
+  tzset();
+  lc.periodValid = false;
+}
+
+void localClockTick() {
+  lc.tickValid = false;
+}
+
+time_t localClockNow() {
+  if (!lc.tickValid) {
+    lc.tickNow = halTime();
+    lc.tickValid = true;
+  }
+  return lc.tickNow;
+}
+
+bool localClockTime(struct tm *info) {
+  time_t now = localClockNow();
+  if (now < CLOCK_VALID_AFTER) return false;
+  localClockAt(now, info);
+  return true;
+}
+
+void localClockAt(time_t epoch, struct tm *info) {
+  if (!lc.periodValid || epoch < lc.periodStart || epoch >= lc.periodEnd) lookupPeriod(epoch);
+
+  int64_t local = (int64_t)epoch + lc.offset;
+  int64_t minute = (local >= 0 ? local : local - 59) / 60;
+  int second = local - minute * 60;
+
+  if (minute != lc.cachedMinute) {
+    int64_t days = (minute >= 0 ? minute : minute - 1439) / 1440;
+    int minuteOfDay = minute - days * 1440;
+    int y, m, d;
+    civilFromDays(days, y, m, d);
+
+    struct tm &t = lc.cachedTm;
+    t.tm_year  = y - 1900;
+    t.tm_mon   = m - 1;
+    t.tm_mday  = d;
+    t.tm_hour  = minuteOfDay / 60;
+    t.tm_min   = minuteOfDay % 60;
+    t.tm_wday  = ((days + 4) % 7 + 7) % 7;  // 1970-01-01 was a Thursday
+    t.tm_yday  = days - daysFromCivil(y, 1, 1);
+    t.tm_isdst = lc.isDst;
+    lc.cachedMinute = minute;
+  }
+
+  *info = lc.cachedTm;
+  info->tm_sec = second;
+}
+
+uint32_t localClockLookups() {
+  return lc.lookups;
+}
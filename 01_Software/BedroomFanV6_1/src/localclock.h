@@ -0,0 +1,28 @@
+#pragma once
+
+#include <Arduino.h>
+#include <time.h>
+
+/*
+Local time from a cached UTC offset.
+
+localtime_r() parses the POSIX TZ rule again on every call. This module
+keeps the offset of the current DST period, with the epochs where that
+period starts and ends, so converting a time is an addition and some
+calendar arithmetic. localtime_r() is only used again when a time falls
+outside the period: at a DST transition, or after the wall clock jumped.
+Within a minute the broken-down time is reused and only the seconds change.
+
+All jobs read one consistent "now": the scheduler starts a new tick before
+each job, the first read in a tick takes the wall clock, later reads in the
+same tick get the same moment. Code that sets the clock starts a new tick.
+The time zone is set here as well, so the cached period goes with it.
+*/
+
+// ======== FUNCTIONS ================
+void   localClockSetZone(const char *tz);      // POSIX TZ rule, e.g. "CET-1CEST,M3.5.0,M10.5.0/3"
+void   localClockTick();                       // Start a new tick, the next read takes the wall clock
+time_t localClockNow();                        // Epoch of this tick
+bool   localClockTime(struct tm *info);        // Local time of this tick, false while the clock is not set
+void   localClockAt(time_t epoch, struct tm *info); // Local time of any moment
+uint32_t localClockLookups();                  // Number of DST period lookups with localtime_r()
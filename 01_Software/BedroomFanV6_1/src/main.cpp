@@ -11,6 +11,19 @@
 #include "fancontrol.h"
 #include "wifi_connect.h"
 #include "telegram.h"
+#include "metrics.h"
+#include "timesync.h"
+#include "rtcstate.h"
+#include "boot.h"
+#include "settings.h"
+#include "power.h"
+#include "scheduler.h"
+#include "updatelog.h"
+#include "commandbus.h"
+#include "serialcli.h"
+#include "mqtt.h"
+#include "httpserver.h"
+#include "remotelog.h"
 
 /*
 Check version.cpp for version history
@@ -38,25 +51,45 @@ The template for this file is:
   // Timezone where the device is located
   // https://github.com/nayarsystems/posix_tz_db/blob/master/zones.csv
   #define localTimezone "CET-1CEST,M3.5.0,M10.5.0/3"
+
+  // Optional: MQTT broker on the local network, see mqtt.h
+  #define mqttBroker "192.168.1.10"
+
+  // Optional: syslog collector for the event log, see remotelog.h
+  #define syslogCollector "192.168.1.10"
 */
 
 void setup()
 {
-  delay(500);
+  // Relay first: restore the fan state before anything slow happens
+  setupTimeSync();
+  setupFan();
+  bootStageDone(bsRelay);
+
   Serial.begin(115200);
-  delay(500);
+  bootStageDone(bsSerial);
 
+  setupPower();
+
+  // WiFi, time and the welcome message complete in the background, see boot.h
   setupWifi();
-  setupFan();
+  setupUpdateLog();
+  setupCommandBus();
+  setupSerialCli();
+  setupMqtt();
+  setupHttp();
+  setupRemoteLog();
   setupTelegram();
+  setupMetrics();
+
+  addPeriodicJob("snapshot", loopStateSnapshot, 10 * MS_PER_SEC, jpHousekeeping, 2);
+  addPeriodicJob("settings", loopSettings,       1 * MS_PER_SEC, jpHousekeeping, 50);
+  addPeriodicJob("boot",     loopBoot,           1 * MS_PER_SEC, jpHousekeeping, 5);
 
   addToEventLog( String("Bedroom fan started. Software version ") + bf_version);
   Serial.println("Init completed");
 }
 
 void loop() {
-  loopWifi();
-  loopFan();
-  loopTelegram();
-  delay(500);
+  runScheduler(); // Runs the jobs that are due, then sleeps until the next one
 }
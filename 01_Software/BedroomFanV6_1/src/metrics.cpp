@@ -0,0 +1,269 @@
+#include "metrics.h"
+
+#include <rom/crc.h>
+
+#include "timer.h"
+#include "fancontrol.h"
+#include "telegram.h"
+#include "wifi_connect.h"
+#include "scheduler.h"
+#include "hal.h"
+
+// ======== CONSTANTS =================
+constexpr size_t MINUTE_ROWS  = 24 * 60; // 1 minute samples for 24 hours
+constexpr size_t QUARTER_ROWS = 24 * 4;  // 15 minute rows for 24 hours
+constexpr size_t DAY_ROWS     = 14;      // Daily rows for two weeks
+
+constexpr uint16_t MINUTES_PER_QUARTER = 15;
+constexpr uint16_t QUARTERS_PER_DAY    = 24 * 4;
+
+constexpr uint32_t RRD_MAGIC = 0x52524431; // "RRD1", bump when the layout changes
+constexpr int16_t  NO_DATA   = INT16_MIN;  // Sample not available (e.g. WiFi down)
+
+struct MetricInfo {
+  const char *name;
+  const char *unit;
+};
+
+static const MetricInfo METRICS[MT_COUNT] = {
+  { "rssi",       "dBm" },
+  { "heap",       "kB"  },
+  { "minheap",    "kB"  },
+  { "block",      "kB"  },
+  { "reconnects", ""    },
+  { "latency",    "ms"  },
+  { "fan",        "s"   },
+};
+
+// ======== TYPES =====================
+struct Aggregate {
+  int16_t min;
+  int16_t avg;
+  int16_t max;
+};
+
+struct Accumulator {
+  int32_t  sum;
+  int16_t  min;
+  int16_t  max;
+  uint16_t count;
+
+  void clear() {
+    sum = 0;
+    min = INT16_MAX;
+    max = INT16_MIN;
+    count = 0;
+  }
+
+  void add(const Aggregate &a) {
+    if (a.avg == NO_DATA) return;
+    sum += a.avg;
+    if (a.min < min) min = a.min;
+    if (a.max > max) max = a.max;
+    count++;
+  }
+
+  void add(int16_t value) { add(Aggregate{ value, value, value }); }
+
+  Aggregate result() const {
+    if (count == 0) return Aggregate{ NO_DATA, NO_DATA, NO_DATA };
+    return Aggregate{ min, int16_t(sum / count), max };
+  }
+};
+
+// Consolidated rows, kept in RTC slow memory (~4.8 kB) so a soft reset does not wipe the history
+struct RrdArchive {
+  uint32_t magic;
+  uint16_t quarterHead;
+  uint16_t quarterCount;
+  uint16_t dayHead;
+  uint16_t dayCount;
+  uint16_t minutesInQuarter;
+  uint16_t quartersInDay;
+
+  Accumulator quarterAcc[MT_COUNT];
+  Accumulator dayAcc[MT_COUNT];
+  Aggregate   quarters[QUARTER_ROWS][MT_COUNT];
+  Aggregate   days[DAY_ROWS][MT_COUNT];
+
+  uint32_t crc;
+};
+
+struct MetricsState {
+  uint32_t lastReconnects = 0;
+  uint32_t lastFanOnSeconds = 0;
+
+  // 1 minute samples do not fit in RTC memory, they are kept in normal RAM
+  int16_t  minutes[MINUTE_ROWS][MT_COUNT];
+  uint16_t minuteHead = 0;
+  uint16_t minuteCount = 0;
+};
+
+RTC_NOINIT_ATTR static RrdArchive rrd;
+static MetricsState metrics;
+
+// ======== HELPERS ===================
+static uint32_t archiveCrc() {
+  return crc32_le(0, (const uint8_t *)&rrd, offsetof(RrdArchive, crc));
+}
+
+static void clearArchive() {
+  memset(&rrd, 0, sizeof(rrd));
+  rrd.magic = RRD_MAGIC;
+  for (int m = 0; m < MT_COUNT; m++) {
+    rrd.quarterAcc[m].clear();
+    rrd.dayAcc[m].clear();
+  }
+  rrd.crc = archiveCrc();
+}
+
+static int16_t clamp16(int32_t value) {
+  if (value > INT16_MAX) return INT16_MAX;
+  if (value <= INT16_MIN) return INT16_MIN + 1;
+  return int16_t(value);
+}
+
+// Ring index of the n-th most recent row
+static size_t recent(size_t head, size_t rows, size_t n) {
+  return (head + rows - 1 - n) % rows;
+}
+
+static void takeSample(int16_t sample[MT_COUNT]) {
+  sample[mtRssi] = halWifiConnected() ? halWifiRssi() : NO_DATA;
+
+  sample[mtFreeHeap]     = clamp16(ESP.getFreeHeap()    / 1024);
+  sample[mtMinFreeHeap]  = clamp16(ESP.getMinFreeHeap() / 1024);
+  sample[mtLargestBlock] = clamp16(ESP.getMaxAllocHeap() / 1024);
+
+  uint32_t reconnects = wifiReconnectCount();
+  sample[mtReconnects] = clamp16(reconnects - metrics.lastReconnects);
+  metrics.lastReconnects = reconnects;
+
+  sample[mtPollLatency] = clamp16(takeMaxPollLatency());
+
+  uint32_t onSeconds = fanOnSeconds();
+  sample[mtFanOnTime] = clamp16(onSeconds - metrics.lastFanOnSeconds);
+  metrics.lastFanOnSeconds = onSeconds;
+}
+
+static void storeSample(const int16_t sample[MT_COUNT]) {
+  // 1 minute archive
+  memcpy(metrics.minutes[metrics.minuteHead], sample, sizeof(metrics.minutes[0]));
+  metrics.minuteHead = (metrics.minuteHead + 1) % MINUTE_ROWS;
+  if (metrics.minuteCount < MINUTE_ROWS) metrics.minuteCount++;
+
+  for (int m = 0; m < MT_COUNT; m++) rrd.quarterAcc[m].add(sample[m]);
+
+  // 15 minute archive
+  if (++rrd.minutesInQuarter >= MINUTES_PER_QUARTER) {
+    for (int m = 0; m < MT_COUNT; m++) {
+      Aggregate row = rrd.quarterAcc[m].result();
+      rrd.quarters[rrd.quarterHead][m] = row;
+      rrd.dayAcc[m].add(row);
+      rrd.quarterAcc[m].clear();
+    }
+    rrd.quarterHead = (rrd.quarterHead + 1) % QUARTER_ROWS;
+    if (rrd.quarterCount < QUARTER_ROWS) rrd.quarterCount++;
+    rrd.minutesInQuarter = 0;
+
+    // Daily archive
+    if (++rrd.quartersInDay >= QUARTERS_PER_DAY) {
+      for (int m = 0; m < MT_COUNT; m++) {
+        rrd.days[rrd.dayHead][m] = rrd.dayAcc[m].result();
+        rrd.dayAcc[m].clear();
+      }
+      rrd.dayHead = (rrd.dayHead + 1) % DAY_ROWS;
+      if (rrd.dayCount < DAY_ROWS) rrd.dayCount++;
+      rrd.quartersInDay = 0;
+    }
+  }
+
+  rrd.crc = archiveCrc();
+}
+
+static String formatValue(int16_t value) {
+  return (value == NO_DATA) ? String("-") : String(value);
+}
+
+static String formatAggregate(const Aggregate &a) {
+  return formatValue(a.min) + "/" + formatValue(a.avg) + "/" + formatValue(a.max);
+}
+
+// ======== PUBLIC API ================
+void setupMetrics() {
+  if (rrd.magic != RRD_MAGIC || rrd.crc != archiveCrc()) {
+    clearArchive();
+  } else {
+    Serial.printf("Metrics restored: %u quarters, %u days\n", rrd.quarterCount, rrd.dayCount);
+  }
+
+  metrics.lastReconnects   = wifiReconnectCount();
+  metrics.lastFanOnSeconds = fanOnSeconds();
+
+  addPeriodicJob("metrics", loopMetrics, MS_PER_MIN, jpHousekeeping, 10);
+}
+
+void loopMetrics() {
+  int16_t sample[MT_COUNT];
+  takeSample(sample);
+  storeSample(sample);
+}
+
+bool metricFromName(const String &name, metric_t &metric) {
+  for (int m = 0; m < MT_COUNT; m++) {
+    if (name == METRICS[m].name) {
+      metric = metric_t(m);
+      return true;
+    }
+  }
+  return false;
+}
+
+String metricsSummary() {
+  String result = "Metric: now | 24h min/avg/max | 7d min/avg/max\n";
+
+  for (int m = 0; m < MT_COUNT; m++) {
+    int16_t now = NO_DATA;
+    if (metrics.minuteCount > 0) now = metrics.minutes[recent(metrics.minuteHead, MINUTE_ROWS, 0)][m];
+
+    Accumulator day;
+    day.clear();
+    day.add(rrd.quarterAcc[m].result());
+    for (size_t i = 0; i < rrd.quarterCount; i++) day.add(rrd.quarters[recent(rrd.quarterHead, QUARTER_ROWS, i)][m]);
+
+    // The rolling 24 hours overlap the last daily row, the week is built from
+    // the day so far and the 6 complete days before it, so nothing counts twice
+    // and the span stays at 7 days
+    Accumulator today = rrd.dayAcc[m];
+    today.add(rrd.quarterAcc[m].result());
+
+    Accumulator week;
+    week.clear();
+    week.add(today.result());
+    for (size_t i = 0; i < rrd.dayCount && i < 6; i++) week.add(rrd.days[recent(rrd.dayHead, DAY_ROWS, i)][m]);
+
+    result += String(METRICS[m].name) + ": " + formatValue(now) + " | " +
+              formatAggregate(day.result()) + " | " + formatAggregate(week.result()) +
+              " " + METRICS[m].unit + "\n";
+  }
+
+  return result;
+}
+
+String metricsHistory(metric_t metric) {
+  String result = String(METRICS[metric].name) + " [" + METRICS[metric].unit + "] min/avg/max\n";
+
+  result += "Last 2 hours:\n";
+  for (size_t i = 0; i < rrd.quarterCount && i < 8; i++) {
+    result += String("  -") + String((i + 1) * MINUTES_PER_QUARTER) + " min: " +
+              formatAggregate(rrd.quarters[recent(rrd.quarterHead, QUARTER_ROWS, i)][metric]) + "\n";
+  }
+
+  result += "Daily:\n";
+  for (size_t i = 0; i < rrd.dayCount; i++) {
+    result += String("  -") + String(i + 1) + " day: " +
+              formatAggregate(rrd.days[recent(rrd.dayHead, DAY_ROWS, i)][metric]) + "\n";
+  }
+
+  return result;
+}
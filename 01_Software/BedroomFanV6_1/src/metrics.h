@@ -0,0 +1,31 @@
+#pragma once
+
+#include <Arduino.h>
+
+/*
+Round robin store for device health data.
+
+Every minute one sample per metric is taken. Samples are kept for 24 hours,
+and are consolidated into 15 minute and daily rows holding min/avg/max.
+The consolidated rows live in RTC memory so they survive a soft reset.
+*/
+
+// ======== TYPES ================
+enum metric_t {
+  mtRssi,          // WiFi signal strength [dBm]
+  mtFreeHeap,      // Free heap [kB]
+  mtMinFreeHeap,   // Lowest free heap since boot [kB]
+  mtLargestBlock,  // Largest allocatable block [kB]
+  mtReconnects,    // WiFi reconnects in the sample period
+  mtPollLatency,   // Slowest Telegram poll in the sample period [ms]
+  mtFanOnTime,     // Seconds the fan was on in the sample period
+  MT_COUNT
+};
+
+// ======== FUNCTIONS ================
+void setupMetrics();
+void loopMetrics();
+
+bool metricFromName(const String& name, metric_t& metric);
+String metricsSummary();              // One line per metric: now, 24h and 7d min/avg/max
+String metricsHistory(metric_t metric); // Recent 15 minute rows and daily rows of one metric
@@ -0,0 +1,464 @@
+#include "mqtt.h"
+
+#include <string.h>
+
+#include "commandbus.h"
+#include "fancontrol.h"
+#include "eventlog.h"
+#include "scheduler.h"
+#include "perf.h"
+#include "timefmt.h"
+#include "wifi_connect.h"
+#include "version.h"
+#include "hal.h"
+#include "myCredentials.h"  // mqttBroker, mqttPort, mqttUser, mqttPassword
+
+// ======== CONSTANTS =================
+constexpr uint16_t DEFAULT_PORT    = 1883;
+constexpr uint16_t KEEP_ALIVE      = 60;                // [s]
+constexpr uint32_t PING_INTERVAL   = 30 * MS_PER_SEC;
+constexpr uint32_t CONNECT_TIMEOUT = 1 * MS_PER_SEC;    // TCP connect, blocks the job
+constexpr uint32_t CONNACK_TIMEOUT = 5 * MS_PER_SEC;
+constexpr uint32_t RETRY_MIN       = 2 * MS_PER_SEC;
+constexpr uint32_t RETRY_MAX       = 64 * MS_PER_SEC;
+constexpr uint32_t POLL_PERIOD     = 1 * MS_PER_SEC;    // Timers and keep alive, input wakes the job at once
+
+constexpr size_t TX_SIZE     = 768;
+constexpr size_t RX_SIZE     = 256;
+constexpr size_t HEADER_ROOM = 5;                      // Fixed header: type and up to 4 length bytes
+
+static const char *BASE      = "bedroomfan";           // Topic prefix and client id
+static const char *USER      = "mqtt";
+
+enum mqttPacket_t : uint8_t {
+  mpConnect   = 0x10,
+  mpConnack   = 0x20,
+  mpPublish   = 0x30,
+  mpSubscribe = 0x82,
+  mpSuback    = 0x90,
+  mpPingreq   = 0xc0,
+  mpPingresp  = 0xd0,
+};
+
+enum stateTopic_t { stRelay, stMode, stClockOn, stClockOff, stTimer, ST_COUNT };
+
+static const char *STATE_TOPICS[ST_COUNT] = { "relay", "mode", "clock_on", "clock_off", "timer_remaining" };
+
+// ======== STATE =====================
+enum mqttState_t { msOff, msDisconnected, msWaitConnack, msConnected };
+
+struct Mqtt {
+  const char *host = nullptr;
+  uint16_t    port = DEFAULT_PORT;
+  mqttState_t state = msOff;
+
+  uint32_t retryAt = 0;
+  uint32_t retryDelay = RETRY_MIN;
+  uint32_t connectStart = 0;
+  uint32_t lastSent = 0;
+  uint32_t lastReceived = 0;
+
+  uint8_t tx[TX_SIZE];
+  size_t  txLength = 0;
+  bool    txOverflow = false;
+  uint8_t rx[RX_SIZE];
+  size_t  rxLength = 0;
+  int64_t rxMicros = 0;              // halMicros() of the last read
+
+  char published[ST_COUNT][12] = {}; // Last retained value per state topic, "" to publish again
+
+  uint32_t connects = 0;
+  uint32_t commands = 0;
+  perf_t   perfCommand = NO_PERF;
+};
+
+static Mqtt m;
+
+// ======== PACKETS ===================
+static void startPacket() {
+  m.txLength = HEADER_ROOM;
+  m.txOverflow = false;
+}
+
+static void putBytes(const void *data, size_t length) {
+  if (m.txLength + length > TX_SIZE) {
+    m.txOverflow = true;
+    return;
+  }
+  memcpy(m.tx + m.txLength, data, length);
+  m.txLength += length;
+}
+
+static void putByte(uint8_t b) {
+  putBytes(&b, 1);
+}
+
+static void putString(const char *text) {
+  size_t length = strlen(text);
+  putByte(length >> 8);
+  putByte(length & 0xff);
+  putBytes(text, length);
+}
+
+static void disconnect(const char *reason);
+
+// Puts the fixed header in front of the body and sends the packet
+static bool sendPacket(uint8_t header) {
+  if (m.txOverflow) return false;
+
+  size_t remaining = m.txLength - HEADER_ROOM;
+  uint8_t length[4];
+  size_t count = 0;
+  do {
+    length[count] = remaining % 128;
+    remaining /= 128;
+    if (remaining > 0) length[count] |= 0x80;
+    count++;
+  } while (remaining > 0);
+
+  size_t start = HEADER_ROOM - 1 - count;
+  m.tx[start] = header;
+  memcpy(m.tx + start + 1, length, count);
+
+  if (!halTcpWrite(m.tx + start, m.txLength - start)) {
+    disconnect("write failed");
+    return false;
+  }
+  m.lastSent = halMillis();
+  return true;
+}
+
+static bool publish(const char *topic, const char *payload, size_t length, bool retain) {
+  startPacket();
+  putString(topic);
+  putBytes(payload, length);
+  return sendPacket(mpPublish | (retain ? 0x01 : 0x00));
+}
+
+// ======== HELPERS ===================
+static String topic(const char *name) {
+  return String(BASE) + "/" + name;
+}
+
+static void retryLater() {
+  halTcpClose();
+  m.state = msDisconnected;
+  m.retryAt = halMillis() + m.retryDelay;
+  m.retryDelay = min(2 * m.retryDelay, RETRY_MAX);
+}
+
+static void disconnect(const char *reason) {
+  if (m.state == msConnected) addToEventLogf("MQTT disconnected: %s", reason);
+  retryLater();
+}
+
+static void stateValue(stateTopic_t state, char *value, size_t size) {
+  switch (state) {
+    case stRelay:    snprintf(value, size, "%s", fanIsOn() ? "ON" : "OFF"); break;
+    case stMode:     snprintf(value, size, "%s", fanModeName()); break;
+    case stClockOn:  snprintf(value, size, "%s", formatClock(clock_on.minutes_after_midnight).c_str()); break;
+    case stClockOff: snprintf(value, size, "%s", formatClock(clock_off.minutes_after_midnight).c_str()); break;
+    case stTimer:    snprintf(value, size, "%u", fanTimerMinutes()); break;
+    default:         value[0] = '\0';
+  }
+}
+
+// Publishes the state topics whose value changed
+static void publishState() {
+  for (int i = 0; i < ST_COUNT && m.state == msConnected; i++) {
+    char value[sizeof(m.published[i])];
+    stateValue((stateTopic_t)i, value, sizeof(value));
+    if (strcmp(value, m.published[i]) == 0) continue;
+
+    if (publish(topic(STATE_TOPICS[i]).c_str(), value, strlen(value), true)) {
+      memcpy(m.published[i], value, sizeof(value));
+    }
+  }
+}
+
+// Retained config message, fields are the entity specific JSON members
+static void publishDiscovery(const char *component, const char *object, const char *fields) {
+  char configTopic[64];
+  char payload[TX_SIZE - 80];
+  snprintf(configTopic, sizeof(configTopic), "homeassistant/%s/%s_%s/config", component, BASE, object);
+  int length = snprintf(payload, sizeof(payload),
+                        "{%s,\"unique_id\":\"%s_%s\",\"availability_topic\":\"%s/availability\","
+                        "\"device\":{\"identifiers\":[\"%s\"],\"name\":\"Bedroom fan\",\"model\":\"ESP32 relay\","
+                        "\"sw_version\":\"%s\"}}",
+                        fields, BASE, object, BASE, BASE, bf_version.c_str());
+  if (length > 0 && (size_t)length < sizeof(payload)) publish(configTopic, payload, length, true);
+}
+
+// Home Assistant: the fan with the modes as presets, the timer and the clock window
+static void publishDiscoveries() {
+  char fields[384];
+
+  snprintf(fields, sizeof(fields),
+           "\"name\":\"Fan\",\"state_topic\":\"%s/relay\",\"command_topic\":\"%s/relay/set\","
+           "\"preset_mode_state_topic\":\"%s/mode\",\"preset_mode_command_topic\":\"%s/mode/set\","
+           "\"preset_modes\":[\"on\",\"off\",\"clock\",\"timer20\",\"timer60\",\"timer240\"]",
+           BASE, BASE, BASE, BASE);
+  publishDiscovery("fan", "fan", fields);
+
+  snprintf(fields, sizeof(fields),
+           "\"name\":\"Timer remaining\",\"state_topic\":\"%s/timer_remaining\",\"unit_of_measurement\":\"min\"",
+           BASE);
+  publishDiscovery("sensor", "timer", fields);
+
+  for (const char *end : { "clock_on", "clock_off" }) {
+    snprintf(fields, sizeof(fields),
+             "\"name\":\"%s\",\"state_topic\":\"%s/%s\",\"command_topic\":\"%s/%s/set\","
+             "\"pattern\":\"^([01]?[0-9]|2[0-3]):[0-5][0-9]$\"",
+             strcmp(end, "clock_on") == 0 ? "Clock on" : "Clock off", BASE, end, BASE, end);
+    publishDiscovery("text", end, fields);
+  }
+}
+
+// The bus ran the command: the relay has switched, show it at once
+static void commandDone(const Command &command, const String &) {
+  perfRecord(m.perfCommand, halMicros() - command.arrivedUs);
+  publishState();
+}
+
+static void handleCommand(const char *name, const char *value) {
+  Command command;
+  command.origin    = coNetwork;
+  command.user      = USER;
+  command.arrivedUs = m.rxMicros;
+  command.reply     = commandDone;
+
+  int minutes = 0;
+  if (strcmp(name, "relay") == 0 && strcmp(value, "ON") == 0)   command.type = cmFanOn;
+  else if (strcmp(name, "relay") == 0 && strcmp(value, "OFF") == 0) command.type = cmFanOff;
+  else if (strcmp(name, "mode") == 0) {
+    if      (strcmp(value, "on") == 0)       command.type = cmFanOn;
+    else if (strcmp(value, "off") == 0)      command.type = cmFanOff;
+    else if (strcmp(value, "clock") == 0)    command.type = cmFanClock;
+    else if (strcmp(value, "timer20") == 0)  { command.type = cmFanTimer; command.argument = tdTimer20; }
+    else if (strcmp(value, "timer60") == 0)  { command.type = cmFanTimer; command.argument = tdTimer60; }
+    else if (strcmp(value, "timer240") == 0) { command.type = cmFanTimer; command.argument = tdTimer240; }
+    else return;
+  }
+  else if (strcmp(name, "clock_on") == 0 && parseClock(value, minutes)) {
+    command.type = cmClockOnShift;
+    command.argument = minutes - clock_on.minutes_after_midnight;
+  }
+  else if (strcmp(name, "clock_off") == 0 && parseClock(value, minutes)) {
+    command.type = cmClockOffShift;
+    command.argument = minutes - clock_off.minutes_after_midnight;
+  }
+  else return;
+
+  m.commands++;
+  postCommand(command);
+}
+
+// <BASE>/<name>/set
+static void handlePublish(uint8_t header, const uint8_t *body, size_t length) {
+  // The broker sets RETAIN only on stored messages it replays for our
+  // subscription: an old command, not a new one
+  if (header & 0x01) return;
+  if (length < 2) return;
+  size_t topicLength = (body[0] << 8) | body[1];
+  size_t offset = 2 + topicLength + ((header & 0x06) ? 2 : 0); // Packet id above QoS 0
+  if (offset > length) return;
+
+  char name[24];
+  char value[16];
+  size_t baseLength = strlen(BASE);
+  const char *t = (const char *)body + 2;
+  if (topicLength < baseLength + 5 || memcmp(t, BASE, baseLength) != 0 || t[baseLength] != '/' ||
+      memcmp(t + topicLength - 4, "/set", 4) != 0) return;
+
+  size_t nameLength = topicLength - baseLength - 5;
+  size_t valueLength = length - offset;
+  if (nameLength >= sizeof(name) || valueLength >= sizeof(value)) return;
+
+  memcpy(name, t + baseLength + 1, nameLength);
+  name[nameLength] = '\0';
+  memcpy(value, body + offset, valueLength);
+  value[valueLength] = '\0';
+  handleCommand(name, value);
+}
+
+static void connected() {
+  m.state = msConnected;
+  m.retryDelay = RETRY_MIN;
+  m.connects++;
+  addToEventLogf("MQTT connected to %s:%u", m.host, m.port);
+
+  startPacket();
+  putByte(0);
+  putByte(1);                                  // Packet id
+  putString(topic("+/set").c_str());
+  putByte(0);                                  // QoS 0
+  if (!sendPacket(mpSubscribe)) return;
+
+  publishDiscoveries();
+  publish(topic("availability").c_str(), "online", 6, true);
+  for (auto &value : m.published) value[0] = '\0';
+  publishState();
+}
+
+static void handlePacket(uint8_t header, const uint8_t *body, size_t length) {
+  switch (header & 0xf0) {
+    case mpConnack:
+      if (m.state != msWaitConnack) break;
+      if (length >= 2 && body[1] == 0) connected();
+      else {
+        addToEventLogf("MQTT broker %s refused the connection, code %u", m.host, length >= 2 ? body[1] : 0);
+        retryLater();
+      }
+      break;
+    case mpPublish:
+      handlePublish(header, body, length);
+      break;
+    default:
+      break; // SUBACK, PINGRESP
+  }
+}
+
+// Reads what arrived and handles every complete packet
+static void receive() {
+  while (m.state == msWaitConnack || m.state == msConnected) {
+    int n = halTcpRead(m.rx + m.rxLength, RX_SIZE - m.rxLength);
+    if (n < 0) {
+      disconnect("closed by the broker");
+      return;
+    }
+    if (n == 0) return;
+    m.rxLength += n;
+    m.rxMicros = halMicros();
+    m.lastReceived = halMillis();
+
+    while (m.rxLength >= 2) {
+      size_t remaining = 0;
+      size_t count = 0;
+      uint8_t b;
+      do {
+        if (1 + count >= m.rxLength) return; // Length not complete yet
+        b = m.rx[1 + count];
+        remaining |= (size_t)(b & 0x7f) << (7 * count);
+        count++;
+      } while ((b & 0x80) && count < 4);
+
+      size_t total = 1 + count + remaining;
+      if (total > RX_SIZE) {
+        disconnect("packet too large");
+        return;
+      }
+      if (m.rxLength < total) break;
+
+      handlePacket(m.rx[0], m.rx + 1 + count, remaining);
+      if (m.state == msDisconnected) return;
+      m.rxLength -= total;
+      memmove(m.rx, m.rx + total, m.rxLength);
+    }
+  }
+}
+
+static void connect() {
+  m.rxLength = 0;
+  if (!halTcpConnect(m.host, m.port, CONNECT_TIMEOUT)) {
+    retryLater();
+    return;
+  }
+
+  uint8_t flags = 0x02 | 0x04 | 0x20;          // Clean session, will, will retained
+#ifdef mqttUser
+  flags |= 0x80;
+#endif
+#ifdef mqttPassword
+  flags |= 0x40;
+#endif
+
+  startPacket();
+  putString("MQTT");
+  putByte(4);                                  // Protocol level 3.1.1
+  putByte(flags);
+  putByte(KEEP_ALIVE >> 8);
+  putByte(KEEP_ALIVE & 0xff);
+  putString(BASE);                             // Client id
+  putString(topic("availability").c_str());
+  putString("offline");
+#ifdef mqttUser
+  putString(mqttUser);
+#endif
+#ifdef mqttPassword
+  putString(mqttPassword);
+#endif
+  if (!sendPacket(mpConnect)) return;
+
+  m.state = msWaitConnack;
+  m.connectStart = halMillis();
+  m.lastReceived = m.connectStart;
+}
+
+// ======== PUBLIC API ================
+void mqttSetBroker(const char *host, uint16_t port) {
+  m.host = host;
+  m.port = port;
+}
+
+void setupMqtt() {
+#ifdef mqttBroker
+  if (m.host == nullptr) m.host = mqttBroker;
+#ifdef mqttPort
+  m.port = mqttPort;
+#endif
+#endif
+  if (m.host == nullptr) return;
+
+  m.state = msDisconnected;
+  m.perfCommand = perfSection("mqtt cmd");
+  job_t job = addPeriodicJob("mqtt", loopMqtt, POLL_PERIOD, jpNetwork, CONNECT_TIMEOUT + 100);
+  wakeOnNetwork(job);
+}
+
+void loopMqtt() {
+  uint32_t now = halMillis();
+
+  if (m.state == msOff) return;
+  if (!wifiIsConnected()) {
+    if (m.state != msDisconnected) disconnect("WiFi down");
+    return;
+  }
+
+  switch (m.state) {
+    case msDisconnected:
+      if ((int32_t)(now - m.retryAt) >= 0) connect();
+      break;
+    case msWaitConnack:
+      receive();
+      if (m.state == msWaitConnack && now - m.connectStart >= CONNACK_TIMEOUT) retryLater();
+      break;
+    case msConnected:
+      receive();
+      if (m.state != msConnected) break;
+      publishState(); // Changes made by the timer, the clock or other front ends
+      if (now - m.lastSent >= PING_INTERVAL) {
+        startPacket();
+        sendPacket(mpPingreq);
+      }
+      if (now - m.lastReceived >= KEEP_ALIVE * 1500) disconnect("keep alive timeout");
+      break;
+    default:
+      break;
+  }
+}
+
+String mqttStatus() {
+  char text[96];
+  switch (m.state) {
+    case msOff:
+      return "MQTT off";
+    case msConnected:
+      snprintf(text, sizeof(text), "MQTT connected to %s:%u, %u connects, %u commands",
+               m.host, m.port, m.connects, m.commands);
+      break;
+    default:
+      snprintf(text, sizeof(text), "MQTT connecting to %s:%u", m.host, m.port);
+      break;
+  }
+  return String(text);
+}
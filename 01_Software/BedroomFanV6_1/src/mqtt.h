@@ -0,0 +1,40 @@
+#pragma once
+
+#include <Arduino.h>
+
+/*
+MQTT client for control on the local network.
+
+Telegram needs the internet and takes seconds per command, a broker on the
+LAN answers in milliseconds. The client publishes the state of the fan as
+retained messages, only when a value changed:
+
+  bedroomfan/relay            ON | OFF
+  bedroomfan/mode             on | off | clock | timer20 | timer60 | timer240
+  bedroomfan/clock_on         hh:mm
+  bedroomfan/clock_off        hh:mm
+  bedroomfan/timer_remaining  minutes
+  bedroomfan/availability     online | offline (last will)
+
+and takes commands on <topic>/set for relay, mode, clock_on and clock_off.
+Commands go through the command bus, the time from arrival until the bus
+has run them is recorded as the "mqtt cmd" perf section.
+
+Home Assistant finds the fan, the timer sensor and the clock window through
+retained discovery messages under homeassistant/.
+
+The broker comes from myCredentials.h, without it the client stays off:
+
+  #define mqttBroker "192.168.1.10"
+  #define mqttPort 1883               // optional
+  #define mqttUser "fan"              // optional
+  #define mqttPassword "secret"       // optional
+
+MQTT 3.1.1 with QoS 0 only, over halTcp* (hal.h).
+*/
+
+// ======== FUNCTIONS ================
+void setupMqtt();
+void loopMqtt();
+void mqttSetBroker(const char *host, uint16_t port); // Instead of myCredentials.h, before setupMqtt()
+String mqttStatus();
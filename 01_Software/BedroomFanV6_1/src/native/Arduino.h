@@ -0,0 +1,219 @@
+#pragma once
+
+/*
+Arduino API for the host build.
+
+Only the part the portable modules use: String, Serial, ESP and the pin and
+time functions. Pins and time go through the HAL, see hal.h.
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include <algorithm>
+#include <string>
+#include <type_traits>
+
+#include "hal.h"
+
+// ======== CONSTANTS ================
+#define HIGH   0x1
+#define LOW    0x0
+#define INPUT  0x01
+#define OUTPUT 0x03
+
+#define DEC 10
+#define HEX 16
+
+// RTC memory is plain memory on the host, it does not survive a restart
+#define RTC_NOINIT_ATTR
+#define RTC_DATA_ATTR
+
+using std::min;
+using std::max;
+
+// newlib has strlcpy, glibc only since 2.38
+#if defined(__GLIBC__) && !__GLIBC_PREREQ(2, 38)
+inline size_t strlcpy(char *dst, const char *src, size_t size) {
+  size_t len = strlen(src);
+  if (size > 0) {
+    size_t n = len < size - 1 ? len : size - 1;
+    memcpy(dst, src, n);
+    dst[n] = '\0';
+  }
+  return len;
+}
+#endif
+
+// ======== PINS AND TIME ================
+inline uint32_t millis()                           { return halMillis(); }
+inline uint32_t micros()                           { return (uint32_t)halMicros(); }
+inline void     delay(uint32_t ms)                 { halDelay(ms); }
+inline void     pinMode(uint8_t pin, uint8_t mode) { halPinMode(pin, mode); }
+inline void     digitalWrite(uint8_t pin, uint8_t level) { halDigitalWrite(pin, level); }
+inline int      digitalRead(uint8_t pin)           { return halDigitalRead(pin); }
+
+// ======== STRING ================
+class String {
+  public:
+    String() {}
+    String(const char *text) : s(text ? text : "") {}
+    String(const std::string &text) : s(text) {}
+    explicit String(char c) : s(1, c) {}
+    explicit String(unsigned char value, unsigned char base = DEC) : String((unsigned long long)value, base) {}
+    explicit String(int value, unsigned char base = DEC) : String((long long)value, base) {}
+    explicit String(unsigned int value, unsigned char base = DEC) : String((unsigned long long)value, base) {}
+    explicit String(long value, unsigned char base = DEC) : String((long long)value, base) {}
+    explicit String(unsigned long value, unsigned char base = DEC) : String((unsigned long long)value, base) {}
+    explicit String(long long value, unsigned char base = DEC) {
+      if (value < 0 && base == DEC) s = "-" + String((unsigned long long)-value, base).s;
+      else s = String((unsigned long long)value, base).s;
+    }
+    explicit String(unsigned long long value, unsigned char base = DEC) {
+      char buf[66];
+      char *p = buf + sizeof(buf) - 1;
+      *p = '\0';
+      do {
+        int digit = value % base;
+        *--p = digit < 10 ? '0' + digit : 'A' + digit - 10;
+        value /= base;
+      } while (value > 0);
+      s = p;
+    }
+    explicit String(float value, unsigned int decimals = 2) : String((double)value, decimals) {}
+    explicit String(double value, unsigned int decimals = 2) {
+      char buf[48];
+      snprintf(buf, sizeof(buf), "%.*f", (int)decimals, value);
+      s = buf;
+    }
+
+    unsigned int length() const { return s.length(); }
+    bool isEmpty() const        { return s.empty(); }
+    const char *c_str() const   { return s.c_str(); }
+    bool reserve(unsigned int size) { s.reserve(size); return true; }
+    void clear()                { s.clear(); }
+
+    char charAt(unsigned int index) const     { return index < s.length() ? s[index] : 0; }
+    char operator[](unsigned int index) const { return charAt(index); }
+    char &operator[](unsigned int index)      { return s[index]; }
+
+    String &operator+=(const String &rhs) { s += rhs.s; return *this; }
+    String &operator+=(const char *rhs)   { if (rhs) s += rhs; return *this; }
+    String &operator+=(char rhs)          { s += rhs; return *this; }
+    template <typename T, typename = typename std::enable_if<std::is_arithmetic<T>::value>::type>
+    String &operator+=(T rhs)             { return *this += String(rhs); }
+    bool concat(const String &rhs)        { s += rhs.s; return true; }
+
+    bool equals(const String &rhs) const   { return s == rhs.s; }
+    int compareTo(const String &rhs) const { return s.compare(rhs.s); }
+    bool operator==(const String &rhs) const { return s == rhs.s; }
+    bool operator==(const char *rhs) const   { return s == (rhs ? rhs : ""); }
+    bool operator!=(const String &rhs) const { return s != rhs.s; }
+    bool operator!=(const char *rhs) const   { return !(*this == rhs); }
+    bool operator<(const String &rhs) const  { return s < rhs.s; }
+
+    bool startsWith(const String &prefix) const { return s.compare(0, prefix.s.length(), prefix.s) == 0; }
+    bool endsWith(const String &suffix) const {
+      return s.length() >= suffix.s.length() && s.compare(s.length() - suffix.s.length(), suffix.s.length(), suffix.s) == 0;
+    }
+
+    int indexOf(char c, unsigned int from = 0) const           { return toIndex(s.find(c, from)); }
+    int indexOf(const String &text, unsigned int from = 0) const { return toIndex(s.find(text.s, from)); }
+    int lastIndexOf(char c) const                               { return toIndex(s.rfind(c)); }
+
+    String substring(unsigned int from) const { return from < s.length() ? String(s.substr(from)) : String(); }
+    String substring(unsigned int from, unsigned int to) const {
+      if (from > to) std::swap(from, to);
+      if (from >= s.length()) return String();
+      return String(s.substr(from, to - from));
+    }
+
+    long  toInt() const   { return strtol(s.c_str(), nullptr, 10); }
+    float toFloat() const { return strtof(s.c_str(), nullptr); }
+
+    void toLowerCase() { for (char &c : s) c = tolower((unsigned char)c); }
+    void toUpperCase() { for (char &c : s) c = toupper((unsigned char)c); }
+    void trim() {
+      size_t first = s.find_first_not_of(" \t\r\n");
+      size_t last  = s.find_last_not_of(" \t\r\n");
+      s = (first == std::string::npos) ? std::string() : s.substr(first, last - first + 1);
+    }
+    void replace(const String &find, const String &with) {
+      if (find.s.empty()) return;
+      for (size_t pos = 0; (pos = s.find(find.s, pos)) != std::string::npos; pos += with.s.length()) {
+        s.replace(pos, find.s.length(), with.s);
+      }
+    }
+    void remove(unsigned int index, unsigned int count = (unsigned int)-1) {
+      if (index < s.length()) s.erase(index, count);
+    }
+
+  private:
+    std::string s;
+
+    static int toIndex(size_t pos) { return pos == std::string::npos ? -1 : (int)pos; }
+};
+
+inline String operator+(const String &lhs, const String &rhs) { String r(lhs); r += rhs; return r; }
+inline String operator+(const String &lhs, const char *rhs)   { String r(lhs); r += rhs; return r; }
+inline String operator+(const char *lhs, const String &rhs)   { String r(lhs); r += rhs; return r; }
+inline String operator+(const String &lhs, char rhs)          { String r(lhs); r += rhs; return r; }
+template <typename T, typename = typename std::enable_if<std::is_arithmetic<T>::value>::type>
+inline String operator+(const String &lhs, T rhs)             { String r(lhs); r += rhs; return r; }
+inline bool operator==(const char *lhs, const String &rhs)    { return rhs == lhs; }
+
+// ======== SERIAL ================
+class HardwareSerial {
+  public:
+    void begin(unsigned long baud) { (void)baud; }
+    void flush() { fflush(stdout); }
+
+    int available() { return input.size() - inputRead; }
+    int read() {
+      if (inputRead == input.size()) return -1;
+      int c = (unsigned char)input[inputRead++];
+      if (inputRead == input.size()) { input.clear(); inputRead = 0; }
+      return c;
+    }
+    void feed(const String &text) { input += text.c_str(); } // Host only: bytes that arrive on RX
+
+    size_t print(const String &text) { return fputs(text.c_str(), stdout) >= 0 ? text.length() : 0; }
+    size_t print(const char *text)   { return print(String(text)); }
+    template <typename T>
+    size_t print(T value)            { return print(String(value)); }
+
+    size_t println()                   { return print("\n"); }
+    template <typename T>
+    size_t println(T value)            { return print(value) + println(); }
+
+    size_t printf(const char *fmt, ...) __attribute__((format(printf, 2, 3))) {
+      va_list args;
+      va_start(args, fmt);
+      int n = vprintf(fmt, args);
+      va_end(args);
+      return n > 0 ? n : 0;
+    }
+
+  private:
+    std::string input;
+    size_t inputRead = 0;
+};
+
+extern HardwareSerial Serial;
+
+// ======== ESP ================
+class EspClass {
+  public:
+    uint32_t getFreeHeap();
+    uint32_t getMinFreeHeap();
+    uint32_t getMaxAllocHeap();
+    void restart();
+};
+
+extern EspClass ESP;
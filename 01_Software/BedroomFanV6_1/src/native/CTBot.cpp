@@ -0,0 +1,57 @@
+#include "CTBot.h"
+
+#include "bot_transport.h"
+
+// ======== KEYBOARD ==================
+bool CTBotInlineKeyboard::addButton(const String &text, const String &command, CTBotInlineKeyboardButtonType buttonType) {
+  rows.back().push_back(Button{ text, command, buttonType });
+  return true;
+}
+
+String CTBotInlineKeyboard::getJSON() const {
+  String json = "{\"inline_keyboard\":[";
+  bool firstRow = true;
+
+  for (const auto &row : rows) {
+    if (row.empty()) continue;
+    if (!firstRow) json += ",";
+    firstRow = false;
+
+    json += "[";
+    for (size_t i = 0; i < row.size(); i++) {
+      if (i > 0) json += ",";
+      json += String("{\"text\":\"") + row[i].text + "\",\"" +
+              (row[i].type == CTBotKeyboardButtonURL ? "url" : "callback_data") + "\":\"" + row[i].command + "\"}";
+    }
+    json += "]";
+  }
+
+  return json + "]}";
+}
+
+// ======== BOT =======================
+CTBotMessageType CTBot::getNewMessage(TBMessage &message, bool blocking) {
+  (void)blocking;
+  return botTransport().getUpdate(message) ? message.messageType : CTBotMessageNoData;
+}
+
+int32_t CTBot::sendMessage(int64_t id, const String &message, const String &keyboard) {
+  return botTransport().sendMessage(id, message, keyboard);
+}
+
+int32_t CTBot::sendMessage(int64_t id, const String &message, CTBotInlineKeyboard &keyboard) {
+  return sendMessage(id, message, keyboard.getJSON());
+}
+
+bool CTBot::editMessageText(int64_t id, int32_t messageID, const String &message, const String &keyboard) {
+  return botTransport().editMessage(id, messageID, message, keyboard);
+}
+
+bool CTBot::editMessageText(int64_t id, int32_t messageID, const String &message, CTBotInlineKeyboard &keyboard) {
+  return editMessageText(id, messageID, message, keyboard.getJSON());
+}
+
+bool CTBot::endQuery(const String &queryID, const String &message, bool alertMode) {
+  (void)alertMode;
+  return botTransport().answerQuery(queryID, message);
+}
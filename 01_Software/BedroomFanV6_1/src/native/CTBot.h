@@ -0,0 +1,87 @@
+#pragma once
+
+/*
+CTBot on the host.
+
+Same class and types as the CTBot library, as far as telegram.cpp uses
+them. Instead of HTTPS to api.telegram.org, every call goes to the current
+BotTransport, see bot_transport.h.
+*/
+
+#include <Arduino.h>
+
+#include <vector>
+
+// ======== TYPES ================
+enum CTBotMessageType {
+  CTBotMessageNoData   = 0,
+  CTBotMessageText     = 1,
+  CTBotMessageQuery    = 2,
+  CTBotMessageLocation = 3,
+  CTBotMessageContact  = 4,
+  CTBotMessageDocument = 5,
+};
+
+enum CTBotInlineKeyboardButtonType {
+  CTBotKeyboardButtonURL   = 1,
+  CTBotKeyboardButtonQuery = 2,
+};
+
+struct TBUser {
+  int64_t id = 0;
+  bool    isBot = false;
+  String  firstName;
+  String  lastName;
+  String  username;
+  String  languageCode;
+};
+
+struct TBGroup {
+  int64_t id = 0;
+  String  title;
+};
+
+struct TBMessage {
+  int32_t messageID = 0;
+  TBUser  sender;
+  TBGroup group;
+  int32_t date = 0;
+  String  text;
+  String  chatInstance;
+  String  callbackQueryData;
+  String  callbackQueryID;
+  CTBotMessageType messageType = CTBotMessageNoData;
+};
+
+class CTBotInlineKeyboard {
+  public:
+    void flushData() { rows.assign(1, {}); }
+    bool addRow()    { rows.push_back({}); return true; }
+    bool addButton(const String &text, const String &command, CTBotInlineKeyboardButtonType buttonType);
+    String getJSON() const; // reply_markup as sent to the Bot API
+
+  private:
+    struct Button {
+      String text;
+      String command;
+      CTBotInlineKeyboardButtonType type;
+    };
+    std::vector<std::vector<Button>> rows { {} };
+};
+
+class CTBot {
+  public:
+    void enableUTF8Encoding(bool value) { (void)value; }
+    void setTelegramToken(const String &token) { (void)token; }
+    bool testConnection() { return true; }
+
+    CTBotMessageType getNewMessage(TBMessage &message, bool blocking = false);
+
+    int32_t sendMessage(int64_t id, const String &message, const String &keyboard = "");
+    int32_t sendMessage(int64_t id, const String &message, CTBotInlineKeyboard &keyboard);
+
+    bool editMessageText(int64_t id, int32_t messageID, const String &message, const String &keyboard = "");
+    bool editMessageText(int64_t id, int32_t messageID, const String &message, CTBotInlineKeyboard &keyboard);
+
+    bool endQuery(const String &queryID, const String &message = "", bool alertMode = false);
+};
@@ -0,0 +1,52 @@
+#pragma once
+
+// NVS on the host: kept in memory for the lifetime of the process
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <Arduino.h>
+
+class Preferences {
+  public:
+    bool begin(const char *name, bool readOnly = false) {
+      space = name;
+      this->readOnly = readOnly;
+      return true;
+    }
+    void end() { space.clear(); }
+
+    bool isKey(const char *key) { return store().count(path(key)) > 0; }
+    bool remove(const char *key) { return !readOnly && store().erase(path(key)) > 0; }
+
+    size_t getBytesLength(const char *key) {
+      auto it = store().find(path(key));
+      return it == store().end() ? 0 : it->second.size();
+    }
+
+    size_t getBytes(const char *key, void *buf, size_t maxLen) {
+      auto it = store().find(path(key));
+      if (it == store().end() || it->second.size() > maxLen) return 0;
+      memcpy(buf, it->second.data(), it->second.size());
+      return it->second.size();
+    }
+
+    size_t putBytes(const char *key, const void *value, size_t len) {
+      if (readOnly) return 0;
+      const uint8_t *bytes = (const uint8_t *)value;
+      store()[path(key)].assign(bytes, bytes + len);
+      return len;
+    }
+
+  private:
+    std::string space;
+    bool readOnly = false;
+
+    std::string path(const char *key) const { return space + "/" + key; }
+
+    static std::map<std::string, std::vector<uint8_t>> &store() {
+      static std::map<std::string, std::vector<uint8_t>> values;
+      return values;
+    }
+};
@@ -0,0 +1,26 @@
+#include <Arduino.h>
+
+#include <malloc.h>
+
+// ======== GLOBALS ===================
+HardwareSerial Serial;
+EspClass ESP;
+
+// ======== ESP =======================
+// The host heap grows on demand, report what the allocator holds free
+uint32_t EspClass::getFreeHeap() {
+  return mallinfo2().fordblks;
+}
+
+uint32_t EspClass::getMinFreeHeap() {
+  return getFreeHeap();
+}
+
+uint32_t EspClass::getMaxAllocHeap() {
+  return getFreeHeap();
+}
+
+void EspClass::restart() {
+  fflush(stdout);
+  exit(0);
+}
@@ -0,0 +1,233 @@
+#include "bot_bench.h"
+
+#include <Arduino.h>
+#include <malloc.h>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "mock_bot_api.h"
+#include "hal_linux.h"
+#include "timer.h"
+#include "myCredentials.h"  // userid, localTimezone
+
+void setup();
+void loop();
+
+// ======== CONSTANTS =================
+constexpr int64_t  GROUP_CHAT   = -1001234567890LL;  // Supergroup ids do not fit in 32 bits
+constexpr int64_t  FIRST_MEMBER = 1000;              // Other members of the group
+constexpr uint32_t GRACE        = 60 * MS_PER_SEC;   // Run on after the last tap, for the replies
+
+static const char *TIMER_BUTTONS[] = { "cb20min", "cb1hr", "cb4hrs" };
+static const char *FAN_BUTTONS[]   = { "cbFanOn", "cbFanOff", "cbFanClock" };
+static const char *CLOCK_BUTTONS[] = { "cbClkOnMHr", "cbClkOnPHr", "cbClkOnM15", "cbClkOnP15",
+                                       "cbClkOffMHr", "cbClkOffPHr", "cbClkOffM15", "cbClkOffP15" };
+
+// ======== TYPES =====================
+struct Tap {
+  uint32_t    at;      // [ms] Since the start of the run
+  int64_t     chatId;
+  int64_t     from;
+  bool        text;    // A typed command instead of a button
+  const char *data;
+  bool        burst;
+};
+
+struct Bench {
+  std::vector<Tap> taps;
+  size_t   nextTap = 0;
+  uint32_t random = 1;
+
+  uint32_t strangerUpdates = 0;
+  size_t   peakBacklog = 0;
+  size_t   heapStart = 0;
+  size_t   heapPeak = 0;
+
+  uint32_t burstAt = 0;       // millis() the burst arrived, 0 before
+  uint32_t burstDrained = 0;  // millis() the backlog was empty again, 0 before
+  uint32_t burstSize = 0;
+};
+
+static Bench bench;
+
+// ======== HELPERS ===================
+static uint32_t nextRandom() {
+  // xorshift32, repeatable for a given seed
+  bench.random ^= bench.random << 13;
+  bench.random ^= bench.random >> 17;
+  bench.random ^= bench.random << 5;
+  return bench.random;
+}
+
+static bool chance(float p) {
+  return nextRandom() % 10000 < p * 10000;
+}
+
+static uint32_t thinkTime() {
+  return 500 + nextRandom() % 2500; // Reading the reply and finding the next button
+}
+
+static size_t heapInUse() {
+  return mallinfo2().uordblks;
+}
+
+// One visit of a user: a few things they came to do, a tap at a time
+static void planSession(uint32_t at, int64_t chatId, float strangers) {
+  auto tap = [&](const char *data, bool text = false) {
+    bool stranger = chatId == GROUP_CHAT && chance(strangers);
+    int64_t from = stranger ? FIRST_MEMBER + nextRandom() % 5 : userid;
+    bench.taps.push_back({ at, chatId, from, text, data, false });
+    at += thinkTime();
+  };
+
+  for (uint32_t errands = 1 + nextRandom() % 3; errands > 0; errands--) {
+    switch (nextRandom() % 6) {
+      case 0:
+        tap("/status", true);
+        break;
+      case 1:
+        tap(FAN_BUTTONS[nextRandom() % 3]);
+        break;
+      case 2:
+        tap(TIMER_BUTTONS[nextRandom() % 3]);
+        break;
+      case 3:
+        tap("cbSettings");
+        tap("cbSetClock");
+        for (uint32_t n = 2 + nextRandom() % 5; n > 0; n--) tap(CLOCK_BUTTONS[nextRandom() % 8]);
+        tap("cbMain");
+        break;
+      case 4:
+        tap("cbSettings");
+        tap("cbEventLog");
+        tap("cbMain");
+        break;
+      case 5:
+        tap("cbStatus");
+        break;
+    }
+  }
+}
+
+static void applyTaps(MockBotApi &api, uint32_t elapsed) {
+  while (bench.nextTap < bench.taps.size() && bench.taps[bench.nextTap].at <= elapsed) {
+    const Tap &tap = bench.taps[bench.nextTap++];
+    if (tap.text) api.pushText(tap.chatId, tap.from, tap.data);
+    else          api.pushQuery(tap.chatId, tap.from, tap.data);
+    if (tap.from != userid) bench.strangerUpdates++;
+    if (tap.burst && bench.burstAt == 0) bench.burstAt = millis();
+  }
+}
+
+static String percentiles(std::vector<uint32_t> samples) {
+  if (samples.empty()) return "-";
+  std::sort(samples.begin(), samples.end());
+  auto at = [&](float p) { return samples[std::min(samples.size() - 1, (size_t)(p * samples.size()))]; };
+  char buf[96];
+  snprintf(buf, sizeof(buf), "p50 %u  p95 %u  p99 %u  max %u  (%u)", at(0.50f), at(0.95f), at(0.99f),
+           samples.back(), (unsigned)samples.size());
+  return String(buf);
+}
+
+// ======== PUBLIC API ================
+int runBotBenchmark(int argc, char **argv) {
+  uint32_t sessions = 200;
+  uint32_t minutes = 30;
+  float    group = 0.3f;
+  float    strangers = 0.1f;
+  uint32_t burst = 20;
+  uint32_t seed = 1;
+  const char *scriptPath = nullptr;
+
+  for (int i = 0; i + 1 < argc; i += 2) {
+    if (strcmp(argv[i], "--sessions") == 0)       sessions = strtoul(argv[i + 1], nullptr, 10);
+    else if (strcmp(argv[i], "--minutes") == 0)   minutes = std::max(1ul, strtoul(argv[i + 1], nullptr, 10));
+    else if (strcmp(argv[i], "--group") == 0)     group = strtof(argv[i + 1], nullptr);
+    else if (strcmp(argv[i], "--strangers") == 0) strangers = strtof(argv[i + 1], nullptr);
+    else if (strcmp(argv[i], "--burst") == 0)     burst = strtoul(argv[i + 1], nullptr, 10);
+    else if (strcmp(argv[i], "--script") == 0)    scriptPath = argv[i + 1];
+    else if (strcmp(argv[i], "--seed") == 0)      seed = strtoul(argv[i + 1], nullptr, 10);
+    else {
+      fprintf(stderr, "Unknown option %s\n", argv[i]);
+      return 2;
+    }
+  }
+  bench.random = seed ? seed : 1;
+
+  // Sessions spread over the window, a burst from the group chat halfway
+  uint32_t window = minutes * MS_PER_MIN;
+  for (uint32_t n = 0; n < sessions; n++) {
+    planSession(nextRandom() % window, chance(group) ? GROUP_CHAT : userid, strangers);
+  }
+  for (uint32_t n = 0; n < burst; n++) {
+    int64_t from = chance(strangers) ? FIRST_MEMBER + nextRandom() % 5 : userid;
+    bench.taps.push_back({ window / 2, GROUP_CHAT, from, false, FAN_BUTTONS[nextRandom() % 3], true });
+  }
+  bench.burstSize = burst;
+  std::stable_sort(bench.taps.begin(), bench.taps.end(), [](const Tap &a, const Tap &b) { return a.at < b.at; });
+
+  // Virtual clock from January 1st, local time
+  setenv("TZ", localTimezone, 1);
+  tzset();
+  struct tm start = {};
+  start.tm_year = 2025 - 1900;
+  start.tm_mday = 1;
+  start.tm_isdst = -1;
+  halLinuxVirtualTime(mktime(&start));
+
+  MockBotApi api;
+  api.seed(seed);
+  if (scriptPath && !api.loadScript(scriptPath)) return 2;
+  api.addChat(userid);
+  api.addChat(GROUP_CHAT);
+  setBotTransport(&api);
+
+  auto wallStart = std::chrono::steady_clock::now();
+
+  setup();
+  uint32_t begin = millis();
+  uint32_t lastActivity = begin;
+  bench.heapStart = bench.heapPeak = heapInUse();
+
+  while (millis() - lastActivity < GRACE) {
+    applyTaps(api, millis() - begin);
+    loop();
+
+    bench.peakBacklog = std::max(bench.peakBacklog, api.backlog());
+    bench.heapPeak = std::max(bench.heapPeak, heapInUse());
+    if (bench.burstAt != 0 && bench.burstDrained == 0 && api.idle()) bench.burstDrained = millis();
+    if (bench.nextTap < bench.taps.size() || !api.idle()) lastActivity = millis();
+  }
+  api.finish();
+  setBotTransport(nullptr);
+
+  double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+  double span = (lastActivity - begin) / 1000.0;
+  const ReplyStats &replies = api.replies();
+
+  printf("Bot benchmark: %u sessions, %u updates in %.1f virtual minutes (%.3f s wall, %.1f us host CPU per update)\n",
+         sessions, replies.updates, span / 60, wall, replies.updates ? wall * 1e6 / replies.updates : 0.0);
+  printf("Throughput: %.2f updates/s on average, peak backlog %u updates\n",
+         span > 0 ? replies.updates / span : 0.0, (unsigned)bench.peakBacklog);
+  if (bench.burstDrained) {
+    double drain = (bench.burstDrained - bench.burstAt) / 1000.0;
+    printf("Burst of %u taps fetched in %.1f s (%.2f updates/s)\n", bench.burstSize, drain,
+           drain > 0 ? bench.burstSize / drain : 0.0);
+  }
+  printf("Tap to answer [ms]: %s\n", percentiles(replies.answerMs).c_str());
+  printf("Tap to reply  [ms]: %s\n", percentiles(replies.replyMs).c_str());
+  printf("Unanswered %u (%u from other group members), unsolicited %u, to unknown chats %u\n",
+         replies.unanswered, bench.strangerUpdates, replies.unsolicited, replies.unknownChat);
+
+  printf("%-20s %7s %7s %7s %7s\n", "Bot API method", "calls", "errors", "drops", "429");
+  for (int m = 0; m < BM_COUNT; m++) {
+    const MethodStats &s = api.stats((botMethod_t)m);
+    printf("%-20s %7u %7u %7u %7u\n", MockBotApi::methodName((botMethod_t)m), s.calls, s.errors, s.drops, s.rateLimited);
+  }
+  printf("Heap in use [bytes]: start %u, peak %u, end %u\n",
+         (unsigned)bench.heapStart, (unsigned)bench.heapPeak, (unsigned)heapInUse());
+
+  return replies.unknownChat > 0 ? 1 : 0;
+}
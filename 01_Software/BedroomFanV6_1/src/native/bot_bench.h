@@ -0,0 +1,21 @@
+#pragma once
+
+/*
+End-to-end benchmark of the Telegram layer against the Bot API stand-in.
+
+Synthetic users tap through the keyboards the way people do: switch the
+fan, set a timer, edit the clock window, read the event log, ask for the
+status. Their sessions start at random (but repeatable) moments, a part of
+them in a group chat where other members tap along, and halfway a burst of
+button presses arrives at once. The firmware runs unchanged under the
+virtual clock, with the latency and faults of MockBotApi.
+
+  program --bench-bot [--sessions n] [--minutes m] [--group p] [--strangers p]
+                      [--burst n] [--script faults.txt] [--seed n]
+
+Reports the throughput, the latency from a tap to the answer and to the
+reply (p50/p95/p99/max), the Bot API calls and faults per method, and the
+heap in use on the host. Exits with 1 if a reply went to an unknown chat.
+*/
+
+int runBotBenchmark(int argc, char **argv);
@@ -0,0 +1,64 @@
+#include "bot_transport.h"
+
+// ======== STATE =====================
+static BotTransport *current = nullptr;
+
+// ======== CONSOLE TRANSPORT =========
+void ConsoleTransport::pushText(int64_t from, const String &text) {
+  TBMessage message;
+  message.messageID   = nextMessageId++;
+  message.sender.id   = from;
+  message.date        = halTime();
+  message.text        = text;
+  message.messageType = CTBotMessageText;
+  updates.push_back(message);
+}
+
+void ConsoleTransport::pushQuery(int64_t from, const String &data) {
+  TBMessage message;
+  message.messageID         = nextMessageId - 1; // The message with the keyboard
+  message.sender.id         = from;
+  message.date              = halTime();
+  message.callbackQueryData = data;
+  message.callbackQueryID   = String(nextQueryId++);
+  message.messageType       = CTBotMessageQuery;
+  updates.push_back(message);
+}
+
+bool ConsoleTransport::getUpdate(TBMessage &message) {
+  if (updates.empty()) return false;
+  message = updates.front();
+  updates.pop_front();
+  return true;
+}
+
+int32_t ConsoleTransport::sendMessage(int64_t chatId, const String &text, const String &keyboard) {
+  (void)keyboard;
+  if (echo) printf("[bot -> %lld #%d] %s\n", (long long)chatId, nextMessageId, text.c_str());
+  return nextMessageId++;
+}
+
+bool ConsoleTransport::editMessage(int64_t chatId, int32_t messageId, const String &text, const String &keyboard) {
+  (void)keyboard;
+  if (echo) printf("[bot -> %lld edit #%d] %s\n", (long long)chatId, messageId, text.c_str());
+  return true;
+}
+
+bool ConsoleTransport::answerQuery(const String &queryId, const String &text) {
+  if (echo) printf("[bot answer %s] %s\n", queryId.c_str(), text.c_str());
+  return true;
+}
+
+// ======== PUBLIC API ================
+void setBotTransport(BotTransport *transport) {
+  current = transport;
+}
+
+BotTransport &botTransport() {
+  return current ? *current : consoleTransport();
+}
+
+ConsoleTransport &consoleTransport() {
+  static ConsoleTransport console;
+  return console;
+}
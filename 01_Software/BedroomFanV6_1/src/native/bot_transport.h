@@ -0,0 +1,49 @@
+#pragma once
+
+/*
+Bot API transport for the host build.
+
+CTBot.h sends every Bot API call to the current transport. The default is
+the console transport: updates are queued by the host program, replies are
+printed to stdout. Other transports can be installed with setBotTransport().
+*/
+
+#include <Arduino.h>
+#include <CTBot.h>
+
+#include <deque>
+
+// ======== TYPES ================
+class BotTransport {
+  public:
+    virtual ~BotTransport() {}
+
+    virtual bool getUpdate(TBMessage &message) = 0; // Next update, false if there is none
+    virtual int32_t sendMessage(int64_t chatId, const String &text, const String &keyboard) = 0; // Message id, 0 on failure
+    virtual bool editMessage(int64_t chatId, int32_t messageId, const String &text, const String &keyboard) = 0;
+    virtual bool answerQuery(const String &queryId, const String &text) = 0;
+};
+
+class ConsoleTransport : public BotTransport {
+  public:
+    void pushText(int64_t from, const String &text);  // Queue a text message from a user
+    void pushQuery(int64_t from, const String &data); // Queue a button press
+    bool idle() const { return updates.empty(); }     // All updates handed to the firmware
+    void setEcho(bool on) { echo = on; }               // Print the replies of the bot
+
+    bool getUpdate(TBMessage &message) override;
+    int32_t sendMessage(int64_t chatId, const String &text, const String &keyboard) override;
+    bool editMessage(int64_t chatId, int32_t messageId, const String &text, const String &keyboard) override;
+    bool answerQuery(const String &queryId, const String &text) override;
+
+  private:
+    std::deque<TBMessage> updates;
+    int32_t nextMessageId = 1;
+    uint32_t nextQueryId = 1;
+    bool echo = true;
+};
+
+// ======== FUNCTIONS ================
+void setBotTransport(BotTransport *transport); // nullptr restores the console transport
+BotTransport &botTransport();
+ConsoleTransport &consoleTransport();
@@ -0,0 +1,31 @@
+#pragma once
+
+// Power management on the host: not built in, like the prebuilt Arduino SDK
+
+#include <stdint.h>
+
+typedef int esp_err_t;
+typedef void *esp_pm_lock_handle_t;
+
+#define ESP_OK                0
+#define ESP_ERR_NOT_SUPPORTED 0x106
+
+typedef enum { ESP_PM_CPU_FREQ_MAX, ESP_PM_APB_FREQ_MAX, ESP_PM_NO_LIGHT_SLEEP } esp_pm_lock_type_t;
+
+typedef struct {
+  int  max_freq_mhz;
+  int  min_freq_mhz;
+  bool light_sleep_enable;
+} esp_pm_config_esp32_t;
+
+inline esp_err_t esp_pm_configure(const void *) { return ESP_ERR_NOT_SUPPORTED; }
+inline esp_err_t esp_pm_lock_create(esp_pm_lock_type_t, int, const char *, esp_pm_lock_handle_t *handle) {
+  *handle = nullptr;
+  return ESP_ERR_NOT_SUPPORTED;
+}
+inline esp_err_t esp_pm_lock_acquire(esp_pm_lock_handle_t) { return ESP_ERR_NOT_SUPPORTED; }
+inline esp_err_t esp_pm_lock_release(esp_pm_lock_handle_t) { return ESP_ERR_NOT_SUPPORTED; }
+
+inline const char *esp_err_to_name(esp_err_t err) {
+  return err == ESP_OK ? "ESP_OK" : "ESP_ERR_NOT_SUPPORTED";
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+// esp_timer on the host: the HAL monotonic clock
+
+#include "hal.h"
+
+inline int64_t esp_timer_get_time() { return halMicros(); }
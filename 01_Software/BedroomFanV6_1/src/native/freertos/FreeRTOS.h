@@ -0,0 +1,8 @@
+#pragma once
+
+// FreeRTOS on the host: there are no tasks to inspect
+
+#include <stdint.h>
+
+typedef void *TaskHandle_t;
+typedef uint32_t UBaseType_t;
@@ -0,0 +1,7 @@
+#pragma once
+
+#include "FreeRTOS.h"
+
+inline TaskHandle_t xTaskGetHandle(const char *) { return nullptr; }
+inline UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t) { return 0; }
+inline TaskHandle_t xTaskGetCurrentTaskHandle() { return (TaskHandle_t)1; } // One task on the host
@@ -0,0 +1,332 @@
+#include "hal_linux.h"
+
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <stdio.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+// ======== CONSTANTS =================
+constexpr uint8_t PIN_COUNT = 40;
+
+// ======== STATE =====================
+struct LinuxHal {
+  uint8_t pinModes[PIN_COUNT] = {};
+  uint8_t pinLevels[PIN_COUNT] = {};
+
+  pinChangeCallback_t onPinChange = nullptr;
+
+  time_t wallOffset = 0;    // halSetTime() minus the Linux or virtual clock
+
+  bool     virtualTime = false;
+  int64_t  virtualUs = 0;
+  time_t   virtualWallStart = 0;
+  uint32_t virtualMillisStart = 0;
+
+  bool   wifiConnected = true;
+  int8_t wifiRssi = -60;
+};
+
+static LinuxHal hal;
+
+// ======== HELPERS ===================
+static int64_t monotonicUs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+// Zero at the first call, like esp_timer at boot
+static int64_t uptimeUs() {
+  static const int64_t boot = monotonicUs();
+  return hal.virtualTime ? hal.virtualUs : monotonicUs() - boot;
+}
+
+static time_t wallClock() {
+  return hal.virtualTime ? hal.virtualWallStart + hal.virtualUs / 1000000 : time(nullptr);
+}
+
+// ======== GPIO ======================
+void halPinMode(uint8_t pin, uint8_t mode) {
+  if (pin < PIN_COUNT) hal.pinModes[pin] = mode;
+}
+
+void halDigitalWrite(uint8_t pin, uint8_t level) {
+  if (pin >= PIN_COUNT) return;
+  bool changed = hal.pinLevels[pin] != level;
+  hal.pinLevels[pin] = level;
+  if (changed && hal.onPinChange) hal.onPinChange(pin, level);
+}
+
+int halDigitalRead(uint8_t pin) {
+  return pin < PIN_COUNT ? hal.pinLevels[pin] : 0;
+}
+
+uint8_t halLinuxPinMode(uint8_t pin) {
+  return pin < PIN_COUNT ? hal.pinModes[pin] : 0;
+}
+
+void halLinuxOnPinChange(pinChangeCallback_t callback) {
+  hal.onPinChange = callback;
+}
+
+// ======== CLOCKS ====================
+uint32_t halMillis() {
+  if (hal.virtualTime) return hal.virtualMillisStart + (uint32_t)(hal.virtualUs / 1000);
+  return uptimeUs() / 1000;
+}
+
+int64_t halMicros() {
+  return uptimeUs();
+}
+
+void halDelay(uint32_t ms) {
+  if (hal.virtualTime) halLinuxAdvance(ms);
+  else usleep(ms * 1000);
+}
+
+time_t halTime() {
+  return wallClock() + hal.wallOffset;
+}
+
+void halSetTime(time_t epoch) {
+  hal.wallOffset = epoch - wallClock();
+}
+
+void halLinuxVirtualTime(time_t wallStart, uint32_t millisStart) {
+  hal.virtualTime = true;
+  hal.virtualUs = 0;
+  hal.virtualWallStart = wallStart;
+  hal.virtualMillisStart = millisStart;
+  hal.wallOffset = 0;
+}
+
+void halLinuxAdvance(uint32_t ms) {
+  hal.virtualUs += (int64_t)ms * 1000;
+}
+
+bool halLocalTime(struct tm *info) {
+  time_t now = halTime();
+  localtime_r(&now, info);
+  return true; // The Linux clock is always set, the virtual clock starts set
+}
+
+// Real time even under the virtual clock, benchmarks measure the host
+uint32_t halCycleCount() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint32_t)((uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec);
+}
+
+uint32_t halCycleHz() {
+  return 1000000000;
+}
+
+// ======== WIFI ======================
+bool halWifiConnected() {
+  return hal.wifiConnected;
+}
+
+int8_t halWifiRssi() {
+  return hal.wifiConnected ? hal.wifiRssi : 0;
+}
+
+void halLinuxSetWifi(bool connected, int8_t rssi) {
+  hal.wifiConnected = connected;
+  hal.wifiRssi = rssi;
+}
+
+// ======== TCP =======================
+// A real socket, also under the virtual clock
+static int tcpSocket = -1;
+
+bool halTcpConnect(const char *host, uint16_t port, uint32_t timeoutMs) {
+  halTcpClose();
+
+  struct addrinfo hints = {};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  char service[8];
+  snprintf(service, sizeof(service), "%u", port);
+
+  struct addrinfo *addresses;
+  if (getaddrinfo(host, service, &hints, &addresses) != 0) return false;
+
+  for (struct addrinfo *a = addresses; a != nullptr && tcpSocket < 0; a = a->ai_next) {
+    int fd = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+    if (fd < 0) continue;
+    struct timeval timeout = { (time_t)(timeoutMs / 1000), (suseconds_t)(timeoutMs % 1000 * 1000) };
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout)); // Bounds connect() too
+    if (connect(fd, a->ai_addr, a->ai_addrlen) == 0) tcpSocket = fd;
+    else close(fd);
+  }
+  freeaddrinfo(addresses);
+  if (tcpSocket < 0) return false;
+
+  int one = 1;
+  setsockopt(tcpSocket, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  return true;
+}
+
+bool halTcpConnected() {
+  return tcpSocket >= 0;
+}
+
+int halTcpRead(uint8_t *buffer, size_t size) {
+  if (tcpSocket < 0) return -1;
+  ssize_t n = recv(tcpSocket, buffer, size, MSG_DONTWAIT);
+  if (n > 0) return n;
+  if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) return 0;
+  halTcpClose(); // Closed by the peer or failed
+  return -1;
+}
+
+bool halTcpWrite(const uint8_t *data, size_t length) {
+  while (tcpSocket >= 0 && length > 0) {
+    ssize_t n = send(tcpSocket, data, length, MSG_NOSIGNAL);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) {
+      halTcpClose();
+      return false;
+    }
+    data += n;
+    length -= n;
+  }
+  return tcpSocket >= 0;
+}
+
+void halTcpClose() {
+  if (tcpSocket >= 0) close(tcpSocket);
+  tcpSocket = -1;
+}
+
+// ======== TCP SERVER ================
+static uint16_t listenPort = 0;
+static int listenSocket = -1;
+static int connSockets[HAL_MAX_CONNECTIONS] = { -1, -1, -1, -1 };
+
+void halLinuxListenPort(uint16_t port) {
+  listenPort = port;
+}
+
+bool halServerBegin(uint16_t port) {
+  (void)port;
+  if (listenPort == 0) return false;
+
+  listenSocket = socket(AF_INET6, SOCK_STREAM | SOCK_NONBLOCK, 0);
+  if (listenSocket < 0) return false;
+  int one = 1;
+  int zero = 0;
+  setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  setsockopt(listenSocket, IPPROTO_IPV6, IPV6_V6ONLY, &zero, sizeof(zero));
+
+  struct sockaddr_in6 address = {};
+  address.sin6_family = AF_INET6;
+  address.sin6_addr = in6addr_any;
+  address.sin6_port = htons(listenPort);
+  if (bind(listenSocket, (struct sockaddr *)&address, sizeof(address)) != 0 || listen(listenSocket, 16) != 0) {
+    close(listenSocket);
+    listenSocket = -1;
+    return false;
+  }
+  printf("Listening on port %u\n", listenPort);
+  return true;
+}
+
+int halServerAccept() {
+  if (listenSocket < 0) return -1;
+  int fd = accept4(listenSocket, nullptr, nullptr, SOCK_NONBLOCK);
+  if (fd < 0) return -1;
+
+  for (int conn = 0; conn < HAL_MAX_CONNECTIONS; conn++) {
+    if (connSockets[conn] < 0) {
+      int one = 1;
+      setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+      connSockets[conn] = fd;
+      return conn;
+    }
+  }
+  close(fd); // All slots busy
+  return -1;
+}
+
+int halConnRead(int conn, uint8_t *buffer, size_t size) {
+  if (connSockets[conn] < 0) return -1;
+  ssize_t n = recv(connSockets[conn], buffer, size, MSG_DONTWAIT);
+  if (n > 0) return n;
+  if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) return 0;
+  return -1;
+}
+
+int halConnWrite(int conn, const uint8_t *data, size_t length) {
+  if (connSockets[conn] < 0) return -1;
+  ssize_t n = send(connSockets[conn], data, length, MSG_DONTWAIT | MSG_NOSIGNAL);
+  if (n >= 0) return n;
+  if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) return 0;
+  return -1;
+}
+
+void halConnClose(int conn) {
+  if (connSockets[conn] >= 0) close(connSockets[conn]);
+  connSockets[conn] = -1;
+}
+
+// Linux has its own mDNS responder
+void halAdvertise(const char *hostname, const char *service, uint16_t port) {
+  (void)hostname;
+  (void)service;
+  (void)port;
+}
+
+// ======== NETWORK WAIT ============
+bool halNetWait(uint32_t ms) {
+  if (hal.virtualTime) {
+    halLinuxAdvance(ms); // Nothing arrives in virtual time
+    return false;
+  }
+
+  struct pollfd fds[2 + HAL_MAX_CONNECTIONS];
+  nfds_t count = 0;
+  if (tcpSocket >= 0) fds[count++] = { tcpSocket, POLLIN, 0 };
+  if (listenSocket >= 0) fds[count++] = { listenSocket, POLLIN, 0 };
+  for (int fd : connSockets) if (fd >= 0) fds[count++] = { fd, POLLIN, 0 };
+
+  return poll(fds, count, ms) > 0;
+}
+
+// ======== UDP =======================
+// Connected, so send() knows the destination
+static int udpSocket = -1;
+
+bool halUdpBegin(const char *host, uint16_t port) {
+  if (udpSocket >= 0) close(udpSocket);
+  udpSocket = -1;
+
+  struct addrinfo hints = {};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_DGRAM;
+  char service[8];
+  snprintf(service, sizeof(service), "%u", port);
+
+  struct addrinfo *addresses;
+  if (getaddrinfo(host, service, &hints, &addresses) != 0) return false;
+
+  for (struct addrinfo *a = addresses; a != nullptr && udpSocket < 0; a = a->ai_next) {
+    int fd = socket(a->ai_family, a->ai_socktype | SOCK_NONBLOCK, a->ai_protocol);
+    if (fd < 0) continue;
+    if (connect(fd, a->ai_addr, a->ai_addrlen) == 0) udpSocket = fd;
+    else close(fd);
+  }
+  freeaddrinfo(addresses);
+  return udpSocket >= 0;
+}
+
+// Fails with EAGAIN on a full socket buffer, and once after an ICMP port unreachable
+bool halUdpSend(const uint8_t *data, size_t length) {
+  if (udpSocket < 0) return false;
+  return send(udpSocket, data, length, MSG_DONTWAIT | MSG_NOSIGNAL) == (ssize_t)length;
+}
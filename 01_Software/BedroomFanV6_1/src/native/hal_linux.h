@@ -0,0 +1,25 @@
+#pragma once
+
+/*
+Controls of the simulated hardware on the Linux host, see hal.h.
+*/
+
+#include "hal.h"
+
+// ======== TYPES ================
+typedef void (*pinChangeCallback_t)(uint8_t pin, uint8_t level);
+
+// ======== FUNCTIONS ================
+void halLinuxSetWifi(bool connected, int8_t rssi = -60); // Link state seen by the firmware
+uint8_t halLinuxPinMode(uint8_t pin);
+void halLinuxOnPinChange(pinChangeCallback_t callback);  // Called on every level change of a pin
+
+// Virtual time: the clocks only advance in halDelay() and halLinuxAdvance(),
+// so the firmware runs as fast as the host can execute it. millisStart sets
+// the first millis() value, to reach the 49 day wrap early.
+void halLinuxVirtualTime(time_t wallStart, uint32_t millisStart = 0);
+void halLinuxAdvance(uint32_t ms);
+
+// The server of hal.h listens on this port instead, 0 (the default) for no
+// server, so the simulations do not open ports
+void halLinuxListenPort(uint16_t port);
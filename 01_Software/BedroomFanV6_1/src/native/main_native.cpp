@@ -0,0 +1,122 @@
+#include <Arduino.h>
+
+/*
+Host program: the firmware's setup() and loop() on Linux.
+
+Lines on stdin act as the Telegram user:
+  /status, /perf, ...  text message
+  @cbFanOn, @cb20min   button press (callback data)
+  >on, >timer 20       line on the serial console, see serialcli.h
+  wifi on | wifi off   link state
+  quit
+Replies of the bot are printed to stdout.
+
+  program --simulate ...   runs a simulation instead, see simulation.h
+  program --bench-bot ...  benchmarks the Telegram layer, see bot_bench.h
+  program --replay ...     replays recorded updates, see replay.h
+  program --bench          runs the microbenchmarks, see bench.h
+
+  program --mqtt host[:port]    console with the MQTT client, see mqtt.h
+  program --http port           console with the HTTP server, see httpserver.h
+  program --syslog host[:port]  console sending the event log, see remotelog.h
+The options combine.
+*/
+
+#include <poll.h>
+#include <unistd.h>
+
+#include "bot_transport.h"
+#include "bot_bench.h"
+#include "simulation.h"
+#include "replay.h"
+#include "bench.h"
+#include "mqtt.h"
+#include "remotelog.h"
+#include "hal_linux.h"
+#include "fancontrol.h"
+#include "scheduler.h"
+#include "timer.h"
+#include "myCredentials.h"  // userid
+
+// pio test -e native builds this file too, the test brings its own main()
+#ifndef PIO_UNIT_TESTING
+
+void setup();
+void loop();
+
+// ======== CONSTANTS =================
+constexpr uint32_t EOF_GRACE = 2 * MS_PER_SEC; // Keep running after the last update, for the replies
+
+// ======== STATE =====================
+static bool running = true;
+static bool inputClosed = false;
+static uint32_t lastUpdateAt = 0;
+
+// ======== HELPERS ===================
+static void handleLine(String line) {
+  line.trim();
+  if (line.isEmpty()) return;
+
+  if (line == "quit")          running = false;
+  else if (line == "wifi on")  halLinuxSetWifi(true);
+  else if (line == "wifi off") halLinuxSetWifi(false);
+  else if (line.startsWith("@")) consoleTransport().pushQuery(userid, line.substring(1));
+  else if (line.startsWith(">")) Serial.feed(line.substring(1) + "\n");
+  else                          consoleTransport().pushText(userid, line);
+}
+
+static void loopConsole() {
+  if (inputClosed) {
+    if (!consoleTransport().idle()) lastUpdateAt = millis();
+    else if (millis() - lastUpdateAt >= EOF_GRACE) running = false;
+    return;
+  }
+
+  struct pollfd fd = { STDIN_FILENO, POLLIN, 0 };
+  while (poll(&fd, 1, 0) > 0) {
+    char line[512];
+    if (fgets(line, sizeof(line), stdin) == nullptr) {
+      inputClosed = true;
+      lastUpdateAt = millis();
+      return;
+    }
+    handleLine(line);
+  }
+}
+
+// ======== MAIN ======================
+int main(int argc, char **argv) {
+  setvbuf(stdout, nullptr, _IOLBF, 0);
+
+  if (argc > 1 && strcmp(argv[1], "--simulate") == 0)  return runSimulation(argc - 2, argv + 2);
+  if (argc > 1 && strcmp(argv[1], "--bench-bot") == 0) return runBotBenchmark(argc - 2, argv + 2);
+  if (argc > 1 && strcmp(argv[1], "--replay") == 0)    return runReplay(argc - 2, argv + 2);
+  if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+    setup();
+    printf("%s", runBenchmarks().c_str());
+    return 0;
+  }
+
+  for (int i = 1; i + 1 < argc; i += 2) {
+    if (strcmp(argv[i], "--mqtt") == 0) {
+      char *port = strchr(argv[i + 1], ':');
+      if (port) *port++ = '\0';
+      mqttSetBroker(argv[i + 1], port ? atoi(port) : 1883);
+    }
+    else if (strcmp(argv[i], "--http") == 0) halLinuxListenPort(atoi(argv[i + 1]));
+    else if (strcmp(argv[i], "--syslog") == 0) {
+      char *port = strchr(argv[i + 1], ':');
+      if (port) *port++ = '\0';
+      remoteLogSetCollector(argv[i + 1], port ? atoi(port) : 514);
+    }
+  }
+
+  setup();
+  addPeriodicJob("console", loopConsole, 100, jpControl, 5);
+
+  while (running) loop();
+
+  printf("Relay %s at exit\n", fanIsOn() ? "on" : "off");
+  return 0;
+}
+#endif
@@ -0,0 +1,231 @@
+#include "mock_bot_api.h"
+
+// ======== CONSTANTS =================
+constexpr uint32_t SOCKET_TIMEOUT = 5000;    // [ms] Until the client gives up on a silent socket
+constexpr uint32_t ERROR_LATENCY  = 50;      // [ms] A 5xx or 429 comes back quickly
+constexpr uint32_t RETRY_AFTER    = 5000;    // [ms] retry_after of a 429
+
+static const char *METHOD_NAMES[BM_COUNT] = {
+  "getUpdates", "sendMessage", "editMessageText", "answerCallbackQuery", "sendDocument"
+};
+
+// ======== HELPERS ===================
+static int methodByName(const char *name) {
+  if (strcmp(name, "*") == 0) return -1;
+  for (int m = 0; m < BM_COUNT; m++) {
+    if (strcmp(name, METHOD_NAMES[m]) == 0) return m;
+  }
+  return -2;
+}
+
+// ======== MOCK BOT API ==============
+MockBotApi::MockBotApi() {
+  FaultRule base; // Typical round trips to api.telegram.org over a home connection
+  base.latencyMs = 250;
+  base.jitterMs = 150;
+  rules.push_back(base);
+  startMs = halMillis();
+}
+
+const char *MockBotApi::methodName(botMethod_t method) {
+  return METHOD_NAMES[method];
+}
+
+bool MockBotApi::loadScript(const char *path) {
+  FILE *file = fopen(path, "r");
+  if (!file) {
+    perror(path);
+    return false;
+  }
+
+  char line[256];
+  int lineNumber = 0;
+  bool ok = true;
+  while (fgets(line, sizeof(line), file)) {
+    lineNumber++;
+    char *hash = strchr(line, '#');
+    if (hash) *hash = '\0';
+
+    char name[32];
+    FaultRule r;
+    int fields = sscanf(line, "%31s %u %u %f %f %f %u %u", name, &r.latencyMs, &r.jitterMs,
+                        &r.errorRate, &r.dropRate, &r.rateLimitRate, &r.fromSec, &r.toSec);
+    if (fields <= 0) continue;
+    r.method = methodByName(name);
+    if (fields < 3 || fields == 7 || r.method == -2) {
+      fprintf(stderr, "%s:%d: expected: method latency jitter [error drop 429 [from_s to_s]]\n", path, lineNumber);
+      ok = false;
+      continue;
+    }
+    rules.push_back(r);
+  }
+  fclose(file);
+  return ok;
+}
+
+void MockBotApi::pushText(int64_t chatId, int64_t from, const String &text, int32_t date) {
+  Update update;
+  update.message.messageID   = nextMessageId++;
+  update.message.sender.id   = from;
+  update.message.group.id    = chatId != from ? chatId : 0;
+  update.message.date        = date ? date : halTime();
+  update.message.text        = text;
+  update.message.messageType = CTBotMessageText;
+  update.sentAt = halMillis();
+  updates.push_back(update);
+  addChat(chatId);
+}
+
+void MockBotApi::pushQuery(int64_t chatId, int64_t from, const String &data, int32_t date) {
+  addChat(chatId);
+  Update update;
+  update.message.messageID         = lastMessage[chatId];
+  update.message.sender.id         = from;
+  update.message.group.id          = chatId != from ? chatId : 0;
+  update.message.date              = date ? date : halTime();
+  update.message.callbackQueryData = data;
+  update.message.callbackQueryID   = String(nextQueryId++);
+  update.message.messageType       = CTBotMessageQuery;
+  update.sentAt = halMillis();
+  updates.push_back(update);
+}
+
+void MockBotApi::finish() {
+  replyStats.unanswered += inFlight.size();
+  inFlight.clear();
+}
+
+uint32_t MockBotApi::nextRandom() {
+  // xorshift32, repeatable for a given seed
+  random ^= random << 13;
+  random ^= random >> 17;
+  random ^= random << 5;
+  return random;
+}
+
+const FaultRule &MockBotApi::rule(botMethod_t method) const {
+  uint32_t sinceStart = (halMillis() - startMs) / 1000;
+  for (size_t i = rules.size(); i-- > 1;) {
+    const FaultRule &r = rules[i];
+    if ((r.method == -1 || r.method == method) && sinceStart >= r.fromSec && sinceStart < r.toSec) return r;
+  }
+  return rules[0];
+}
+
+bool MockBotApi::call(botMethod_t method) {
+  MethodStats &s = methodStats[method];
+  s.calls++;
+
+  if (blockedUntil[method] != 0) {
+    if ((int32_t)(blockedUntil[method] - halMillis()) > 0) {
+      halDelay(ERROR_LATENCY);
+      s.rateLimited++;
+      return false;
+    }
+    blockedUntil[method] = 0;
+  }
+
+  const FaultRule &r = rule(method);
+  float dice = (nextRandom() % 10000) / 10000.0f;
+
+  if (dice < r.dropRate) {
+    halDelay(SOCKET_TIMEOUT);
+    s.drops++;
+    return false;
+  }
+  dice -= r.dropRate;
+  if (dice < r.errorRate) {
+    halDelay(ERROR_LATENCY);
+    s.errors++;
+    return false;
+  }
+  dice -= r.errorRate;
+  if (dice < r.rateLimitRate) {
+    halDelay(ERROR_LATENCY);
+    blockedUntil[method] = halMillis() + RETRY_AFTER;
+    s.rateLimited++;
+    return false;
+  }
+
+  halDelay(r.latencyMs + (r.jitterMs ? nextRandom() % r.jitterMs : 0));
+  return true;
+}
+
+void MockBotApi::replied(int64_t chatId) {
+  if (lastMessage.count(chatId) == 0) {
+    replyStats.unknownChat++;
+    return;
+  }
+  auto it = inFlight.find(chatId);
+  if (it == inFlight.end() || it->second.replied) {
+    replyStats.unsolicited++;
+    return;
+  }
+  it->second.replied = true;
+  replyStats.replyMs.push_back(halMillis() - it->second.sentAt);
+  if (it->second.answered || it->second.queryId.isEmpty()) inFlight.erase(it);
+}
+
+void MockBotApi::logCall(botMethod_t method, const String &target, const String &text, const String &keyboard) {
+  if (!callLog) return;
+
+  String line = String(halMillis() - startMs) + " " + METHOD_NAMES[method] + " " + target + " ";
+  for (unsigned int i = 0; i < text.length(); i++) {
+    if (text[i] == '\\')      line += "\\\\";
+    else if (text[i] == '\n') line += "\\n";
+    else                      line += text[i];
+  }
+  if (!keyboard.isEmpty()) line += String(" ") + keyboard;
+  callLog->push_back(line);
+}
+
+bool MockBotApi::getUpdate(TBMessage &message) {
+  if (!call(bmGetUpdates) || updates.empty()) return false;
+
+  const Update &update = updates.front();
+  int64_t chatId = update.message.group.id != 0 ? update.message.group.id : update.message.sender.id;
+  auto previous = inFlight.find(chatId);
+  if (previous != inFlight.end()) {
+    replyStats.unanswered++;
+    inFlight.erase(previous);
+  }
+  inFlight[chatId] = { update.sentAt, update.message.callbackQueryID, false, false };
+  replyStats.updates++;
+
+  message = update.message;
+  updates.pop_front();
+  return true;
+}
+
+int32_t MockBotApi::sendMessage(int64_t chatId, const String &text, const String &keyboard) {
+  if (!call(bmSendMessage)) return 0;
+
+  replied(chatId);
+  logCall(bmSendMessage, String((long long)chatId), text, keyboard);
+  int32_t id = nextMessageId++;
+  if (!keyboard.isEmpty() && lastMessage.count(chatId)) lastMessage[chatId] = id;
+  return id;
+}
+
+bool MockBotApi::editMessage(int64_t chatId, int32_t messageId, const String &text, const String &keyboard) {
+  if (!call(bmEditMessageText)) return false;
+
+  replied(chatId);
+  logCall(bmEditMessageText, String((long long)chatId) + "#" + messageId, text, keyboard);
+  return true;
+}
+
+bool MockBotApi::answerQuery(const String &queryId, const String &text) {
+  if (!call(bmAnswerCallbackQuery)) return false;
+
+  logCall(bmAnswerCallbackQuery, queryId, text, "");
+  for (auto it = inFlight.begin(); it != inFlight.end(); ++it) {
+    if (it->second.queryId != queryId || it->second.answered) continue;
+    it->second.answered = true;
+    replyStats.answerMs.push_back(halMillis() - it->second.sentAt);
+    if (it->second.replied) inFlight.erase(it);
+    return true;
+  }
+  replyStats.unsolicited++;
+  return true;
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+/*
+Stand-in for the Telegram Bot API on the host.
+
+Behaves like api.telegram.org as seen through CTBot: getUpdates hands out
+one update per call (CTBot polls with limit=1) and keeps it until a call
+succeeds, every call takes a while, and calls fail the way they do on a
+bad day:
+  error      the server answers with a 5xx, quickly
+  drop       the socket hangs until the client gives up (SOCKET_TIMEOUT)
+  429        Too Many Requests; the method then fails for retry_after seconds
+
+Latency is spent with halDelay(), so under a virtual clock it costs no
+wall time but shows in millis(), the scheduler and the perf histograms.
+
+A fault script sets latency and fault rates per method, optionally for a
+window of time since the start of the run. One rule per line, the last
+matching rule wins, * matches every method:
+
+  # method            latency jitter error drop  429   [from_s to_s]
+  *                   250     150    0.01  0.005 0
+  sendMessage         300     100    0     0     0.5   120 180
+
+The methods are getUpdates, sendMessage, editMessageText,
+answerCallbackQuery and sendDocument. The firmware never calls
+sendDocument (CTBot 2.1 has no such call), its rule is accepted so scripts
+can be shared with other clients.
+
+Replies are matched to the last update the firmware fetched from the same
+chat, which gives the latency from the moment a user sent an update until
+the spinner stopped (answerCallbackQuery) and until the chat showed the
+reply. A reply to a chat that is not known is an error.
+
+The replies can be logged as text, with the time since the start of the
+run, for a comparison with a golden file:
+
+  <ms> <method> <chat id or query id> <text> [<keyboard JSON>]
+*/
+
+#include <Arduino.h>
+
+#include <deque>
+#include <map>
+#include <vector>
+
+#include "bot_transport.h"
+
+// ======== TYPES ================
+enum botMethod_t {
+  bmGetUpdates,
+  bmSendMessage,
+  bmEditMessageText,
+  bmAnswerCallbackQuery,
+  bmSendDocument,
+  BM_COUNT
+};
+
+struct FaultRule {
+  int      method = -1;   // botMethod_t, -1 for all methods
+  uint32_t latencyMs = 0;
+  uint32_t jitterMs = 0;  // Uniform, added to latencyMs
+  float    errorRate = 0;
+  float    dropRate = 0;
+  float    rateLimitRate = 0;
+  uint32_t fromSec = 0;   // Window since the start of the run
+  uint32_t toSec = UINT32_MAX;
+};
+
+struct MethodStats {
+  uint32_t calls = 0;
+  uint32_t errors = 0;
+  uint32_t drops = 0;
+  uint32_t rateLimited = 0; // Answered with 429, including calls during retry_after
+};
+
+struct ReplyStats {
+  std::vector<uint32_t> answerMs;  // Update sent until answerCallbackQuery
+  std::vector<uint32_t> replyMs;   // Update sent until the first sendMessage or edit for it
+  uint32_t updates = 0;            // Updates handed to the firmware
+  uint32_t unanswered = 0;         // Handed out, but never replied to
+  uint32_t unsolicited = 0;        // Replies to a known chat without a pending update
+  uint32_t unknownChat = 0;        // Replies to a chat that is not known
+};
+
+class MockBotApi : public BotTransport {
+  public:
+    MockBotApi();
+
+    bool loadScript(const char *path); // false if the file cannot be read or has a bad line
+    void addRule(const FaultRule &rule) { rules.push_back(rule); }
+    void seed(uint32_t value) { random = value ? value : 1; }
+
+    void addChat(int64_t chatId) { lastMessage.emplace(chatId, 0); } // Chats the bot may talk to
+    void pushText(int64_t chatId, int64_t from, const String &text, int32_t date = 0);  // date 0: now
+    void pushQuery(int64_t chatId, int64_t from, const String &data, int32_t date = 0);
+    void logCalls(std::vector<String> *log) { callLog = log; } // Successful replies, one line per call
+    bool idle() const { return updates.empty(); }
+    size_t backlog() const { return updates.size(); }
+    void finish();   // Count the updates still waiting for a reply
+
+    const MethodStats &stats(botMethod_t method) const { return methodStats[method]; }
+    const ReplyStats &replies() const { return replyStats; }
+    static const char *methodName(botMethod_t method);
+
+    bool getUpdate(TBMessage &message) override;
+    int32_t sendMessage(int64_t chatId, const String &text, const String &keyboard) override;
+    bool editMessage(int64_t chatId, int32_t messageId, const String &text, const String &keyboard) override;
+    bool answerQuery(const String &queryId, const String &text) override;
+
+  private:
+    struct Update {
+      TBMessage message;
+      uint32_t  sentAt; // millis() when the user sent it
+    };
+
+    bool call(botMethod_t method);  // Spend the latency, false if the call fails
+    const FaultRule &rule(botMethod_t method) const;
+    uint32_t nextRandom();
+    void replied(int64_t chatId);
+    void logCall(botMethod_t method, const String &target, const String &text, const String &keyboard);
+
+    std::vector<FaultRule> rules;
+    std::deque<Update> updates;
+    std::map<int64_t, int32_t> lastMessage; // Known chats, with the message that carries the keyboard
+    uint32_t blockedUntil[BM_COUNT] = {};   // millis(), retry_after of a 429
+    MethodStats methodStats[BM_COUNT];
+    ReplyStats replyStats;
+    std::vector<String> *callLog = nullptr;
+
+    struct InFlight {
+      uint32_t sentAt;
+      String   queryId;   // Empty for a text message
+      bool     answered;  // answerCallbackQuery seen
+      bool     replied;   // sendMessage or edit seen
+    };
+    std::map<int64_t, InFlight> inFlight; // Per chat, the last update handed out
+
+    uint32_t startMs;
+    uint32_t random = 1;
+    int32_t  nextMessageId = 1;
+    uint32_t nextQueryId = 1;
+};
@@ -0,0 +1,237 @@
+#include "replay.h"
+
+#include <Arduino.h>
+
+#include <chrono>
+#include <vector>
+
+#include "mock_bot_api.h"
+#include "hal_linux.h"
+#include "fancontrol.h"
+#include "timer.h"
+#include "myCredentials.h"  // localTimezone
+
+void setup();
+void loop();
+
+// ======== CONSTANTS =================
+constexpr time_t   BOOT_LEAD   = 20;               // [s] Boot before the first update arrives
+constexpr uint32_t GRACE       = 10 * MS_PER_SEC;  // Run on after the last update, for the replies
+constexpr uint32_t LATENCY     = 200;              // [ms] Per Bot API call
+constexpr size_t   MAX_REPORTED = 10;              // Differences printed in full
+
+static const char *MODE_NAMES[] = { "on", "off", "timer", "clock" };
+
+// ======== TYPES =====================
+struct RecordedUpdate {
+  uint32_t at;        // [ms] Since the first update
+  uint32_t date;
+  int64_t  chatId;
+  int64_t  senderId;
+  bool     query;
+  String   data;
+};
+
+struct Replay {
+  std::vector<RecordedUpdate> updates;
+  size_t nextUpdate = 0;
+  std::vector<String> transcript;
+  uint32_t startMs = 0;
+  uint32_t switches = 0;
+};
+
+static Replay replay;
+
+// ======== HELPERS ===================
+static String unescape(const char *text) {
+  String result;
+  for (const char *c = text; *c; c++) {
+    if (*c == '\\' && c[1] == 'n')       { result += '\n'; c++; }
+    else if (*c == '\\' && c[1] == '\\') { result += '\\'; c++; }
+    else                                   result += *c;
+  }
+  return result;
+}
+
+static bool loadRecording(const char *path) {
+  FILE *file = fopen(path, "r");
+  if (!file) {
+    perror(path);
+    return false;
+  }
+
+  char line[512];
+  int lineNumber = 0;
+  uint32_t lastReceived = 0;
+  uint32_t lastDate = 0;
+  uint32_t at = 0;
+  bool ok = true;
+
+  while (fgets(line, sizeof(line), file)) {
+    lineNumber++;
+    line[strcspn(line, "\r\n")] = '\0';
+    if (line[0] == '#' || line[0] == '\0') continue;
+
+    unsigned int received, date;
+    long long chatId, senderId;
+    char type;
+    int dataStart = 0;
+    if (sscanf(line, "%u %u %lld %lld %c %n", &received, &date, &chatId, &senderId, &type, &dataStart) < 5 ||
+        (type != 't' && type != 'q')) {
+      fprintf(stderr, "%s:%d: expected: millis date chat sender t|q data\n", path, lineNumber);
+      ok = false;
+      continue;
+    }
+
+    // millis() restarts after a reset, the dates of the updates bridge the gap
+    if (!replay.updates.empty()) {
+      if (received >= lastReceived) at += received - lastReceived;
+      else if (date > lastDate)     at += (date - lastDate) * MS_PER_SEC;
+    }
+    lastReceived = received;
+    lastDate = date;
+
+    replay.updates.push_back({ at, date, chatId, senderId, type == 'q', unescape(line + dataStart) });
+  }
+  fclose(file);
+  return ok;
+}
+
+static void log(const String &line) {
+  replay.transcript.push_back(String(millis() - replay.startMs) + " " + line);
+}
+
+static void onRelayChange(uint8_t pin, uint8_t level) {
+  if (pin != RELAY_PIN) return;
+  replay.switches++;
+  log(String("relay ") + (level == C_ON ? "on " : "off ") + MODE_NAMES[fanMode]);
+}
+
+static bool writeLines(const char *path, const std::vector<String> &lines) {
+  FILE *file = fopen(path, "w");
+  if (!file) {
+    perror(path);
+    return false;
+  }
+  for (const String &line : lines) fprintf(file, "%s\n", line.c_str());
+  fclose(file);
+  return true;
+}
+
+static bool readLines(const char *path, std::vector<String> &lines) {
+  FILE *file = fopen(path, "r");
+  if (!file) {
+    perror(path);
+    return false;
+  }
+  std::string line;
+  for (int c; (c = fgetc(file)) != EOF;) {
+    if (c != '\n') {
+      line += (char)c;
+      continue;
+    }
+    lines.push_back(String(line));
+    line.clear();
+  }
+  if (!line.empty()) lines.push_back(String(line));
+  fclose(file);
+  return true;
+}
+
+// Number of lines that differ, the first ones are printed
+static size_t compare(const std::vector<String> &golden, const std::vector<String> &actual) {
+  size_t differences = 0;
+  for (size_t i = 0; i < std::max(golden.size(), actual.size()); i++) {
+    const char *expected = i < golden.size() ? golden[i].c_str() : "(end)";
+    const char *got      = i < actual.size() ? actual[i].c_str() : "(end)";
+    if (strcmp(expected, got) == 0) continue;
+    if (++differences <= MAX_REPORTED) printf("line %u:\n- %s\n+ %s\n", (unsigned)i + 1, expected, got);
+  }
+  return differences;
+}
+
+// ======== PUBLIC API ================
+int runReplay(int argc, char **argv) {
+  const char *recordingPath = nullptr;
+  const char *goldenPath = nullptr;
+  const char *outPath = nullptr;
+  const char *scriptPath = nullptr;
+  bool update = false;
+
+  for (int i = 0; i < argc; i++) {
+    if (strcmp(argv[i], "--golden") == 0 && i + 1 < argc)      goldenPath = argv[++i];
+    else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc)    outPath = argv[++i];
+    else if (strcmp(argv[i], "--script") == 0 && i + 1 < argc) scriptPath = argv[++i];
+    else if (strcmp(argv[i], "--update") == 0)                 update = true;
+    else                                                        recordingPath = argv[i];
+  }
+  if (!recordingPath) {
+    fprintf(stderr, "Usage: program --replay updates.txt [--golden expected.txt [--update]] [--out actual.txt]\n");
+    return 2;
+  }
+  if (!loadRecording(recordingPath)) return 2;
+  if (replay.updates.empty()) {
+    fprintf(stderr, "%s: no updates\n", recordingPath);
+    return 2;
+  }
+
+  // Virtual clock a little before the first update, local time as on the board
+  setenv("TZ", localTimezone, 1);
+  tzset();
+  halLinuxVirtualTime(replay.updates[0].date - BOOT_LEAD);
+  halLinuxOnPinChange(onRelayChange);
+
+  MockBotApi api;
+  FaultRule fixed;
+  fixed.latencyMs = LATENCY;
+  api.addRule(fixed);
+  if (scriptPath && !api.loadScript(scriptPath)) return 2;
+  for (const RecordedUpdate &u : replay.updates) api.addChat(u.chatId);
+  api.logCalls(&replay.transcript);
+  setBotTransport(&api);
+
+  auto wallStart = std::chrono::steady_clock::now();
+
+  replay.startMs = millis();
+  setup();
+  uint32_t begin = replay.startMs + BOOT_LEAD * MS_PER_SEC; // The first update arrives here
+  uint32_t lastActivity = millis();
+
+  while (millis() - lastActivity < GRACE) {
+    while (replay.nextUpdate < replay.updates.size() &&
+           (int32_t)(millis() - begin - replay.updates[replay.nextUpdate].at) >= 0) {
+      const RecordedUpdate &u = replay.updates[replay.nextUpdate++];
+      if (u.query) api.pushQuery(u.chatId, u.senderId, u.data, u.date);
+      else         api.pushText(u.chatId, u.senderId, u.data, u.date);
+    }
+    loop();
+    if (replay.nextUpdate < replay.updates.size() || !api.idle()) lastActivity = millis();
+  }
+  api.finish();
+  setBotTransport(nullptr);
+
+  double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+  printf("Replayed %u updates over %.1f virtual seconds in %.1f ms (%.1f us per update): "
+         "%u replies, %u relay switches\n",
+         (unsigned)replay.updates.size(), (millis() - replay.startMs) / 1000.0, wall * 1000,
+         wall * 1e6 / replay.updates.size(), (unsigned)(replay.transcript.size() - replay.switches), replay.switches);
+
+  if (outPath && !writeLines(outPath, replay.transcript)) return 2;
+  if (!goldenPath) return 0;
+
+  if (update) {
+    if (!writeLines(goldenPath, replay.transcript)) return 2;
+    printf("Golden file %s written\n", goldenPath);
+    return 0;
+  }
+
+  std::vector<String> golden;
+  if (!readLines(goldenPath, golden)) return 2;
+  size_t differences = compare(golden, replay.transcript);
+  if (differences == 0) {
+    printf("Transcript matches %s\n", goldenPath);
+    return 0;
+  }
+  printf("%u lines differ from %s\n", (unsigned)differences, goldenPath);
+  return 1;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+/*
+Replay of recorded Telegram updates through the firmware.
+
+Reads a recording in the format of updatelog.h (what /updates sends) and
+hands the updates to the firmware at the recorded moments, under the
+virtual clock and against MockBotApi with a fixed latency of 200 ms per
+call. setup() and loop() run unchanged, so the updates take the same path
+as on the board: loopTelegram(), handleCallback() and the fan.
+
+The outcome is a transcript of every reply and relay switch, with the time
+since the start of the replay:
+
+  <ms> sendMessage <chat id> <text> [<keyboard JSON>]
+  <ms> relay on <mode>
+
+The same recording always gives the same transcript, so a transcript can
+be kept as a golden file and a change that alters behaviour shows up as a
+difference. The run is timed, so a slowdown shows up too.
+
+  program --replay updates.txt [--golden expected.txt [--update]] [--out actual.txt]
+                               [--script faults.txt]
+
+--update writes the golden file instead of comparing with it. Exits with 1
+if the transcript differs from the golden file.
+
+test/replay/ holds a recording with its golden transcript, pio test -e native
+checks it (test/test_replay).
+*/
+
+int runReplay(int argc, char **argv);
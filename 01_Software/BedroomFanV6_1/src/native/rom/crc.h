@@ -0,0 +1,37 @@
+#pragma once
+
+// CRC32 as in the ESP32 ROM, little endian, same polynomial as zlib.
+// Slicing by 8, the simulation checksums the metrics archive every minute.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+inline uint32_t crc32_le(uint32_t crc, const uint8_t *buf, uint32_t len) {
+  static const struct Tables {
+    uint32_t t[8][256];
+    Tables() {
+      for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int bit = 0; bit < 8; bit++) c = (c >> 1) ^ (0xEDB88320 & -(c & 1));
+        t[0][i] = c;
+      }
+      for (uint32_t i = 0; i < 256; i++) {
+        for (int k = 1; k < 8; k++) t[k][i] = (t[k - 1][i] >> 8) ^ t[0][t[k - 1][i] & 0xff];
+      }
+    }
+  } tables;
+  const auto &t = tables.t;
+
+  crc = ~crc;
+  for (; len >= 8; len -= 8, buf += 8) {
+    uint32_t lo, hi;
+    memcpy(&lo, buf, 4);
+    memcpy(&hi, buf + 4, 4);
+    lo ^= crc;
+    crc = t[7][lo & 0xff] ^ t[6][(lo >> 8) & 0xff] ^ t[5][(lo >> 16) & 0xff] ^ t[4][lo >> 24] ^
+          t[3][hi & 0xff] ^ t[2][(hi >> 8) & 0xff] ^ t[1][(hi >> 16) & 0xff] ^ t[0][hi >> 24];
+  }
+  while (len--) crc = t[0][(crc ^ *buf++) & 0xff] ^ (crc >> 8);
+  return ~crc;
+}
@@ -0,0 +1,274 @@
+#include "simulation.h"
+
+#include <Arduino.h>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "bot_transport.h"
+#include "hal_linux.h"
+#include "fancontrol.h"
+#include "timer.h"
+#include "localclock.h"
+#include "myCredentials.h"  // userid, localTimezone
+
+void setup();
+void loop();
+
+// ======== CONSTANTS =================
+constexpr uint32_t MILLIS_START  = 0xFFFFFFFF - 6 * MS_PER_HOUR; // First millis() wrap after 6 hours
+constexpr uint32_t TIMER_SLACK   = 1 * MS_PER_SEC;  // A timer may switch off this late
+constexpr time_t   CLOCK_SLACK   = 2;               // [s] Clock mode may follow a minute boundary this late
+constexpr uint32_t MAX_REPORTED  = 20;              // Violations printed in full
+
+static const char *TIMER_BUTTONS[] = { "cb20min", "cb1hr", "cb4hrs" };
+static const char *CLOCK_BUTTONS[] = { "cbClkOnMHr", "cbClkOnPHr", "cbClkOnM15", "cbClkOnP15",
+                                       "cbClkOffMHr", "cbClkOffPHr", "cbClkOffM15", "cbClkOffP15" };
+static const char *MODE_NAMES[]    = { "on", "off", "timer", "clock" };
+
+// ======== TYPES =====================
+enum simEvent_t { seButton, seWifiDown, seWifiUp };
+
+struct SimEvent {
+  time_t      at;
+  simEvent_t  type;
+  const char *data; // Callback data of a button
+};
+
+struct Simulation {
+  std::vector<SimEvent> events;
+  size_t nextEvent = 0;
+  uint32_t random = 1;
+
+  FILE *timeline = nullptr;
+  bool  running = false;     // setup() done, the relay is checked from here on
+
+  time_t   lastSecond = 0;
+  int      lastIsDst = -1;
+  uint32_t lastMillis = 0;
+
+  uint32_t switches = 0;
+  uint32_t buttons = 0;
+  uint32_t outages = 0;
+  uint32_t wraps = 0;
+  uint32_t dstChanges = 0;
+  uint32_t violations = 0;
+};
+
+static Simulation sim;
+
+// ======== HELPERS ===================
+static uint32_t nextRandom() {
+  // xorshift32, repeatable for a given seed
+  sim.random ^= sim.random << 13;
+  sim.random ^= sim.random >> 17;
+  sim.random ^= sim.random << 5;
+  return sim.random;
+}
+
+static bool chance(float p) {
+  return nextRandom() % 10000 < p * 10000;
+}
+
+static time_t randomBetween(time_t from, time_t to) {
+  return from + nextRandom() % (uint32_t)(to - from);
+}
+
+static time_t localMidnight(time_t start, int day) {
+  struct tm t;
+  localtime_r(&start, &t);
+  t.tm_mday += day;
+  t.tm_hour = t.tm_min = t.tm_sec = 0;
+  t.tm_isdst = -1;
+  return mktime(&t);
+}
+
+static String localTimeString(time_t epoch) {
+  struct tm t;
+  char buf[32];
+  localtime_r(&epoch, &t);
+  strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S %Z", &t);
+  return String(buf);
+}
+
+// A day of a household that uses the fan, and a flaky access point
+static void planDay(time_t midnight) {
+  const time_t HOUR = 3600;
+  auto press = [](time_t at, const char *data) { sim.events.push_back({ at, seButton, data }); };
+
+  if (chance(0.4f)) {
+    time_t on = randomBetween(midnight + 7 * HOUR, midnight + 23 * HOUR);
+    press(on, "cbFanOn");
+    if (chance(0.7f)) press(randomBetween(on + HOUR / 2, on + 3 * HOUR), "cbFanClock");
+  }
+  if (chance(0.3f)) {
+    press(randomBetween(midnight, midnight + 24 * HOUR), TIMER_BUTTONS[nextRandom() % 3]);
+  }
+  if (chance(0.1f)) {
+    time_t off = randomBetween(midnight, midnight + 24 * HOUR);
+    press(off, "cbFanOff");
+    press(randomBetween(off + HOUR, off + 10 * HOUR), "cbFanClock");
+  }
+  if (chance(0.05f)) {
+    time_t edit = randomBetween(midnight, midnight + 24 * HOUR);
+    for (uint32_t n = 1 + nextRandom() % 4; n > 0; n--) press(edit + n * 5, CLOCK_BUTTONS[nextRandom() % 8]);
+  }
+  if (chance(0.15f)) {
+    time_t down = randomBetween(midnight, midnight + 24 * HOUR);
+    time_t length = 60 << (nextRandom() % 9); // 1 minute to about 4 hours
+    sim.events.push_back({ down, seWifiDown, nullptr });
+    sim.events.push_back({ down + length, seWifiUp, nullptr });
+  }
+}
+
+static void applyEvents(time_t now) {
+  while (sim.nextEvent < sim.events.size() && sim.events[sim.nextEvent].at <= now) {
+    const SimEvent &event = sim.events[sim.nextEvent++];
+    switch (event.type) {
+      case seButton:
+        consoleTransport().pushQuery(userid, event.data);
+        sim.buttons++;
+        break;
+      case seWifiDown:
+        halLinuxSetWifi(false);
+        sim.outages++;
+        break;
+      case seWifiUp:
+        halLinuxSetWifi(true);
+        break;
+    }
+  }
+}
+
+static void violation(const String &what) {
+  sim.violations++;
+  if (sim.violations <= MAX_REPORTED) {
+    printf("%s: %s (mode %s, relay %s)\n", localTimeString(halTime()).c_str(), what.c_str(),
+           MODE_NAMES[fanMode], fanIsOn() ? "on" : "off");
+  }
+}
+
+// Fan state the clock window asks for at a moment, written independently of TimeOfDay
+static bool clockWindowOn(time_t epoch) {
+  struct tm t;
+  localtime_r(&epoch, &t);
+  int now = t.tm_hour * 60 + t.tm_min;
+  return now >= clock_on.minutes_after_midnight && now < clock_off.minutes_after_midnight;
+}
+
+static void onRelayChange(uint8_t pin, uint8_t level) {
+  if (pin != RELAY_PIN || !sim.running) return;
+
+  sim.switches++;
+  if (sim.timeline) {
+    fprintf(sim.timeline, "%s,%s,%s\n", localTimeString(halTime()).c_str(),
+            level == C_ON ? "on" : "off", MODE_NAMES[fanMode]);
+  }
+}
+
+static void checkInvariants() {
+  uint32_t ms = millis();
+  if (ms < sim.lastMillis) sim.wraps++;
+  sim.lastMillis = ms;
+
+  bool relayOn = digitalRead(RELAY_PIN) == C_ON;
+  if (relayOn != fanIsOn()) violation("relay pin differs from the fan state");
+
+  switch (fanMode) {
+    case fsOn:
+      if (!relayOn) violation("fan off in on mode");
+      break;
+    case fsOff:
+      if (relayOn) violation("fan on in off mode");
+      break;
+    case fsTimer:
+      if (relayOn && ms - fanTimer.previous > fanTimer.interval + TIMER_SLACK) violation("timer did not switch off");
+      break;
+    case fsClock:
+      break;
+  }
+
+  // Once per virtual second: clock window and DST
+  time_t now = halTime();
+  if (now == sim.lastSecond) return;
+  sim.lastSecond = now;
+
+  if (clock_on.minutes_after_midnight < 0 || clock_off.minutes_after_midnight >= 24 * 60) {
+    violation(String("clock window out of range: ") + clock_on.to_String() + " - " + clock_off.to_String());
+  }
+
+  if (fanMode == fsClock && relayOn != clockWindowOn(now) && relayOn != clockWindowOn(now - CLOCK_SLACK)) {
+    violation(String("clock mode does not follow ") + clock_on.to_String() + " - " + clock_off.to_String());
+  }
+
+  struct tm t;
+  localtime_r(&now, &t);
+  if (sim.lastIsDst >= 0 && t.tm_isdst != sim.lastIsDst) {
+    sim.dstChanges++;
+    if (sim.timeline) fprintf(sim.timeline, "# %s: %s\n", localTimeString(now).c_str(), t.tm_isdst ? "DST starts" : "DST ends");
+  }
+  sim.lastIsDst = t.tm_isdst;
+}
+
+// ======== PUBLIC API ================
+int runSimulation(int argc, char **argv) {
+  int days = 365;
+  uint32_t seed = 1;
+  const char *timelinePath = nullptr;
+
+  for (int i = 0; i < argc; i++) {
+    if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)          seed = strtoul(argv[++i], nullptr, 10);
+    else if (strcmp(argv[i], "--timeline") == 0 && i + 1 < argc) timelinePath = argv[++i];
+    else                                                          days = atoi(argv[i]);
+  }
+  sim.random = seed ? seed : 1;
+
+  if (timelinePath) {
+    sim.timeline = fopen(timelinePath, "w");
+    if (!sim.timeline) {
+      perror(timelinePath);
+      return 2;
+    }
+    fprintf(sim.timeline, "time,relay,mode\n");
+  }
+
+  // Virtual clock from January 1st, local time
+  setenv("TZ", localTimezone, 1);
+  tzset();
+  struct tm start = {};
+  start.tm_year = 2025 - 1900;
+  start.tm_mday = 1;
+  start.tm_isdst = -1;
+  time_t begin = mktime(&start);
+  time_t end = localMidnight(begin, days);
+
+  for (int day = 0; day < days; day++) planDay(localMidnight(begin, day));
+  std::stable_sort(sim.events.begin(), sim.events.end(),
+                   [](const SimEvent &a, const SimEvent &b) { return a.at < b.at; });
+
+  halLinuxVirtualTime(begin, MILLIS_START);
+  halLinuxOnPinChange(onRelayChange);
+  consoleTransport().setEcho(false);
+
+  auto wallStart = std::chrono::steady_clock::now();
+
+  setup();
+  sim.running = true;
+  sim.lastMillis = millis();
+
+  while (halTime() < end) {
+    applyEvents(halTime());
+    loop();
+    checkInvariants();
+  }
+
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+  printf("Simulated %d days in %.1f s: %u relay switches, %u button presses, %u WiFi outages, "
+         "%u millis() wraps, %u DST changes (%u local time lookups), %u violations\n",
+         days, seconds, sim.switches, sim.buttons, sim.outages, sim.wraps, sim.dstChanges, localClockLookups(),
+         sim.violations);
+
+  if (sim.timeline) fclose(sim.timeline);
+  return sim.violations > 0 ? 1 : 0;
+}
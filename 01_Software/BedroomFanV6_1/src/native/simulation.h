@@ -0,0 +1,20 @@
+#pragma once
+
+/*
+Simulation of the firmware against a virtual clock.
+
+Runs setup() and loop() unchanged while the clock jumps ahead to the next
+scheduled job, so a year passes in seconds. On the way it presses buttons
+and drops the WiFi link at random (but repeatable) moments, and crosses the
+DST transitions of localTimezone and the 49 day wrap of millis().
+
+The relay is checked against the fan mode on every change and every
+virtual second: on and off modes hold the relay, a timer switches off when
+it lapses, and clock mode follows the clock window in local time.
+
+  program --simulate [days] [--seed n] [--timeline file.csv]
+
+Exits with 1 if an invariant was violated.
+*/
+
+int runSimulation(int argc, char **argv);
@@ -0,0 +1,60 @@
+#include "timesync.h"
+
+/*
+Time on the host: the HAL wall clock counts as NTP synced, other sources
+can still set it. timesync.cpp replaces this file on the board.
+*/
+
+#include "boot.h"
+#include "hal.h"
+#include "localclock.h"
+#include "myCredentials.h"  // localTimezone
+
+// ======== STATE =====================
+static timeSource_t source = tsNone;
+static uint32_t uncertaintyMs = 0;
+
+// ======== PUBLIC API ================
+void setupTimeSync() {
+  localClockSetZone(localTimezone);
+
+  struct tm timeinfo;
+  if (localClockTime(&timeinfo)) {
+    source = tsNtp;
+    bootStageDone(bsTime);
+  }
+}
+
+void loopTimeSync() {
+}
+
+bool offerTime(timeSource_t offered, time_t epoch, uint32_t offeredUncertaintyMs) {
+  if (offered >= tsNtp || offered < source) return false;
+
+  halSetTime(epoch);
+  localClockTick();
+  source = offered;
+  uncertaintyMs = offeredUncertaintyMs;
+  bootStageDone(bsTime);
+  return true;
+}
+
+timeSource_t timeSource() {
+  return source;
+}
+
+uint32_t timeUncertaintyMs() {
+  return uncertaintyMs;
+}
+
+bool timeIsSynced() {
+  return source == tsNtp;
+}
+
+int32_t ntpOffsetMs() {
+  return 0;
+}
+
+String timeSyncStatus() {
+  return source == tsNone ? "Clock not set" : (timeIsSynced() ? "Clock from the host" : "Clock set by the firmware");
+}
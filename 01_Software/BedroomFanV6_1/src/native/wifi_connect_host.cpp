@@ -0,0 +1,44 @@
+#include "wifi_connect.h"
+
+/*
+WiFi on the host: the link state comes from the simulated HAL link,
+wifi_connect.cpp replaces this file on the board.
+*/
+
+#include "boot.h"
+#include "scheduler.h"
+#include "hal.h"
+
+// ======== STATE =====================
+static bool wasConnected = false;
+static uint32_t reconnects = 0;
+
+// ======== PUBLIC API ================
+void setupWifi() {
+  addPeriodicJob("wifi", loopWifi, 1000, jpNetwork, 20); // Polling, the board reacts to events
+}
+
+void loopWifi() {
+  bool connected = halWifiConnected();
+  if (connected && !wasConnected) {
+    if (bootStageIsDone(bsWifi)) reconnects++;
+    bootStageDone(bsWifi);
+  }
+  wasConnected = connected;
+}
+
+bool wifiIsConnected() {
+  return halWifiConnected();
+}
+
+uint32_t wifiAssociationTime() {
+  return 0;
+}
+
+uint32_t wifiReconnectCount() {
+  return reconnects;
+}
+
+String wifiConnectedTo() {
+  return wifiIsConnected() ? "Connected to the host network" : "Not connected";
+}
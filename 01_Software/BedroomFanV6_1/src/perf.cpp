@@ -0,0 +1,132 @@
+#include "perf.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// ======== CONSTANTS =================
+constexpr size_t  MAX_SECTIONS    = 16;
+constexpr uint8_t SUB_BUCKET_BITS = 2;                     // 4 buckets per power of two
+constexpr size_t  BUCKETS         = 26 << SUB_BUCKET_BITS; // Up to 2^26 us, about a minute
+
+// Tasks of which the stack is watched
+static const char *TASKS[] = { "loopTask", "arduino_events", "wifi", "tiT", "esp_timer", "IDLE" };
+
+// ======== TYPES =====================
+struct Histogram {
+  const char *name;
+  uint32_t count;
+  uint32_t maxUs;
+  uint64_t sumUs;
+  uint32_t buckets[BUCKETS];
+};
+
+// ======== STATE =====================
+static Histogram sections[MAX_SECTIONS];
+static size_t sectionCount = 0;
+
+// ======== HELPERS ===================
+static size_t bucketOf(uint32_t us) {
+  if (us < (1u << SUB_BUCKET_BITS)) return us;
+
+  int msb = 31 - __builtin_clz(us);
+  uint32_t sub = (us >> (msb - SUB_BUCKET_BITS)) & ((1 << SUB_BUCKET_BITS) - 1);
+  size_t bucket = ((msb - SUB_BUCKET_BITS + 1) << SUB_BUCKET_BITS) + sub;
+  return min(bucket, BUCKETS - 1);
+}
+
+// Upper bound of a bucket, the inverse of bucketOf()
+static uint32_t bucketLimit(size_t bucket) {
+  if (bucket < (1u << SUB_BUCKET_BITS)) return bucket + 1;
+
+  int msb = (bucket >> SUB_BUCKET_BITS) + SUB_BUCKET_BITS - 1;
+  uint32_t sub = bucket & ((1 << SUB_BUCKET_BITS) - 1);
+  return ((1u << SUB_BUCKET_BITS) + sub + 1) << (msb - SUB_BUCKET_BITS);
+}
+
+static uint32_t percentile(const Histogram &h, uint32_t permille) {
+  uint32_t target = ((uint64_t)h.count * permille + 999) / 1000;
+  uint32_t seen = 0;
+  for (size_t b = 0; b < BUCKETS; b++) {
+    seen += h.buckets[b];
+    if (seen >= target) return min(bucketLimit(b), h.maxUs);
+  }
+  return h.maxUs;
+}
+
+static String formatMs(uint32_t us) {
+  return String(us / 1000.0f, us < 10000 ? 2u : 0u);
+}
+
+// ======== PUBLIC API ================
+PerfTimer::~PerfTimer() {
+  perfRecord(section, esp_timer_get_time() - start);
+}
+
+perf_t perfSection(const char *name) {
+  for (size_t i = 0; i < sectionCount; i++) {
+    if (strcmp(sections[i].name, name) == 0) return i;
+  }
+  if (sectionCount >= MAX_SECTIONS) return NO_PERF;
+
+  memset(&sections[sectionCount], 0, sizeof(Histogram));
+  sections[sectionCount].name = name;
+  return sectionCount++;
+}
+
+void perfRecord(perf_t section, uint32_t us) {
+  if (section < 0 || (size_t)section >= sectionCount) return;
+
+  Histogram &h = sections[section];
+  h.buckets[bucketOf(us)]++;
+  h.count++;
+  h.sumUs += us;
+  if (us > h.maxUs) h.maxUs = us;
+}
+
+String perfReport() {
+  String result = "Section: count, p50/p95/p99/max ms\n";
+
+  for (size_t i = 0; i < sectionCount; i++) {
+    const Histogram &h = sections[i];
+    if (h.count == 0) continue;
+    result += String(h.name) + ": " + String(h.count) + ", " +
+              formatMs(percentile(h, 500)) + "/" + formatMs(percentile(h, 950)) + "/" +
+              formatMs(percentile(h, 990)) + "/" + formatMs(h.maxUs) + "\n";
+  }
+
+  result += "Stack free (bytes):";
+  for (const char *name : TASKS) {
+    TaskHandle_t task = xTaskGetHandle(name);
+    if (task == nullptr) continue;
+    result += String(" ") + name + " " + String(uxTaskGetStackHighWaterMark(task));
+  }
+
+  result += String("\nHeap free ") + String(ESP.getFreeHeap()) +
+            ", min free " + String(ESP.getMinFreeHeap()) +
+            ", largest block " + String(ESP.getMaxAllocHeap());
+  return result;
+}
+
+size_t perfSectionCount() {
+  return sectionCount;
+}
+
+const char *perfSectionName(perf_t section) {
+  return sections[section].name;
+}
+
+uint32_t perfCount(perf_t section) {
+  return sections[section].count;
+}
+
+uint64_t perfSumUs(perf_t section) {
+  return sections[section].sumUs;
+}
+
+uint32_t perfCountAtMost(perf_t section, uint32_t us) {
+  const Histogram &h = sections[section];
+  uint32_t result = 0;
+  // A bucket holds the times below its limit
+  for (size_t b = 0; b < BUCKETS && bucketLimit(b) <= us + 1; b++) result += h.buckets[b];
+  return result;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <Arduino.h>
+#include <esp_timer.h>
+
+/*
+Latency histograms for timed sections of code.
+
+Each section keeps a histogram with 4 buckets per power of two microseconds,
+so percentiles are accurate to about 20% in a few hundred bytes. Every job
+of the scheduler is a section, as is every network call to Telegram.
+*/
+
+// ======== TYPES ================
+typedef int8_t perf_t;
+
+constexpr perf_t NO_PERF = -1;
+
+// Times the enclosing scope
+class PerfTimer {
+  public:
+    PerfTimer(perf_t section) : section(section), start(esp_timer_get_time()) {}
+    ~PerfTimer();
+  private:
+    perf_t section;
+    int64_t start;
+};
+
+// ======== FUNCTIONS ================
+perf_t perfSection(const char *name);        // Find or add a section
+void perfRecord(perf_t section, uint32_t us);
+String perfReport();                         // Percentiles per section, stacks and heap
+
+// Raw histograms, for /metrics
+size_t perfSectionCount();
+const char *perfSectionName(perf_t section);
+uint32_t perfCount(perf_t section);
+uint64_t perfSumUs(perf_t section);
+uint32_t perfCountAtMost(perf_t section, uint32_t us); // Recordings in buckets that end at or below us
@@ -0,0 +1,130 @@
+#include "power.h"
+
+#include <esp_pm.h>
+#include <esp_timer.h>
+
+#include "eventlog.h"
+
+// ======== CONSTANTS =================
+constexpr bool POWER_SAVE   = true;  // Set to false to run at full speed with the radio always on
+constexpr int  CPU_FREQ_MAX = 240;
+constexpr int  CPU_FREQ_MIN = 80;
+
+// Typical ESP32 supply currents from the datasheet [mA], the report is a model built on them
+constexpr float I_CPU_MAX     = 50.0f;  // 240 MHz, running
+constexpr float I_CPU_MIN     = 15.0f;  // 80 MHz, mostly idle
+constexpr float I_LIGHT_SLEEP = 1.0f;   // Light sleep, radio off between beacons
+constexpr float I_RADIO_RXTX  = 100.0f; // Radio receiving or transmitting
+constexpr float I_MODEM_SLEEP = 5.0f;   // Average of beacon wake-ups at DTIM 1
+constexpr float I_RADIO_ON    = 95.0f;  // Radio always listening
+
+static const char *LOCK_NAMES[PL_COUNT] = { "telegram", "relay" };
+
+// ======== STATE =====================
+struct PowerState {
+  bool dfs = false;         // Dynamic frequency scaling active
+  bool lightSleep = false;  // Automatic light sleep active
+
+  esp_pm_lock_handle_t handles[PL_COUNT] = {};
+  uint8_t  depth[PL_COUNT] = {};
+  int64_t  since[PL_COUNT] = {};
+  int64_t  heldUs[PL_COUNT] = {};
+  uint32_t count[PL_COUNT] = {};
+};
+
+static PowerState power;
+
+// ======== LOCKS =====================
+PowerLock::PowerLock(powerLock_t lock) : lock(lock) {
+  if (power.depth[lock]++ > 0) return;
+
+  power.since[lock] = esp_timer_get_time();
+  power.count[lock]++;
+  if (power.handles[lock]) esp_pm_lock_acquire(power.handles[lock]);
+}
+
+PowerLock::~PowerLock() {
+  if (--power.depth[lock] > 0) return;
+
+  if (power.handles[lock]) esp_pm_lock_release(power.handles[lock]);
+  power.heldUs[lock] += esp_timer_get_time() - power.since[lock];
+}
+
+// ======== PUBLIC API ================
+void setupPower() {
+  if (!POWER_SAVE) return;
+
+#ifndef CONFIG_PM_ENABLE
+  // The prebuilt SDK of arduino-esp32 leaves power management out, the CPU
+  // stays at 240 MHz and the locks only record their time
+  addToEventLog("Power management not built in (CONFIG_PM_ENABLE), CPU at 240 MHz");
+#else
+  esp_pm_config_esp32_t config = {};
+  config.max_freq_mhz = CPU_FREQ_MAX;
+  config.min_freq_mhz = CPU_FREQ_MIN;
+#ifdef CONFIG_FREERTOS_USE_TICKLESS_IDLE
+  config.light_sleep_enable = true;
+#endif
+
+  esp_err_t err = esp_pm_configure(&config);
+  if (err != ESP_OK) {
+    addToEventLog(String("Power management not available: ") + esp_err_to_name(err));
+    return;
+  }
+
+  power.dfs = true;
+  power.lightSleep = config.light_sleep_enable;
+
+  for (int i = 0; i < PL_COUNT; i++) {
+    esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, LOCK_NAMES[i], &power.handles[i]);
+  }
+#endif
+}
+
+bool powerSaveEnabled() {
+  return POWER_SAVE;
+}
+
+String powerReport() {
+  int64_t total = esp_timer_get_time();
+  if (total <= 0) total = 1;
+
+  // Idle current when no lock is held
+  float idleCpu   = power.lightSleep ? I_LIGHT_SLEEP : (power.dfs ? I_CPU_MIN : I_CPU_MAX);
+  float idleRadio = POWER_SAVE ? I_MODEM_SLEEP : I_RADIO_ON;
+
+  String result = String("CPU ") + (power.dfs ? "80-240 MHz" : "240 MHz") +
+                  (power.lightSleep ? ", light sleep" : "") +
+                  (POWER_SAVE ? ", modem sleep" : ", radio always on") + "\n" +
+                  "Currents modelled from lock times and datasheet values, not measured\n";
+
+  float busy = 0;
+  float average = 0;
+  for (int i = 0; i < PL_COUNT; i++) {
+    int64_t held = power.heldUs[i];
+    if (power.depth[i] > 0) held += esp_timer_get_time() - power.since[i];
+
+    float duty = (float)held / total;
+    // Telegram keeps the radio busy, relay switching only the CPU
+    float active = I_CPU_MAX + (i == plTelegram ? I_RADIO_RXTX : idleRadio);
+    float current = duty * active;
+
+    busy += duty;
+    average += current;
+
+    char line[80];
+    snprintf(line, sizeof(line), "%s: %u times, duty %.2f%%, %.2f mA\n",
+             LOCK_NAMES[i], power.count[i], 100 * duty, current);
+    result += line;
+  }
+
+  float idle = max(0.0f, 1 - busy);
+  float idleCurrent = idle * (idleCpu + idleRadio);
+  average += idleCurrent;
+
+  char line[80];
+  snprintf(line, sizeof(line), "idle: duty %.2f%%, %.2f mA\nmodelled average %.1f mA",
+           100 * idle, idleCurrent, average);
+  result += line;
+  return result;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <Arduino.h>
+
+/*
+Power management.
+
+The radio uses modem sleep and wakes at every DTIM beacon, so replies to a
+pending Telegram request still arrive.
+
+With CONFIG_PM_ENABLE in the SDK configuration the CPU runs at 80 MHz, and
+enters light sleep while idle if CONFIG_FREERTOS_USE_TICKLESS_IDLE is set
+too. Full speed is then only requested while a PowerLock is held, around TLS
+traffic and relay switching. The prebuilt SDK of the Arduino framework has
+neither option, that takes an ESP-IDF build with Arduino as a component;
+without it the CPU stays at 240 MHz.
+
+The time each lock is held is recorded either way. The report turns it into
+a model of the duty cycle and average current per subsystem, using typical
+datasheet currents; nothing is measured.
+*/
+
+// ======== TYPES ================
+enum powerLock_t { plTelegram, plRelay, PL_COUNT };
+
+// Holds the CPU at full speed for the lifetime of the object
+class PowerLock {
+  public:
+    PowerLock(powerLock_t lock);
+    ~PowerLock();
+  private:
+    powerLock_t lock;
+};
+
+// ======== FUNCTIONS ================
+void setupPower();
+bool powerSaveEnabled(); // Modem sleep allowed
+String powerReport();    // Duty cycle and modelled current per subsystem
@@ -0,0 +1,165 @@
+#include "prometheus.h"
+
+#include <stdarg.h>
+
+#include "fancontrol.h"
+#include "telegram.h"
+#include "perf.h"
+#include "timesync.h"
+#include "wifi_connect.h"
+#include "remotelog.h"
+#include "hal.h"
+
+// ======== CONSTANTS =================
+static const char *MODES[] = { "on", "off", "clock", "timer20", "timer60", "timer240" };
+
+// Histogram buckets. A perf bucket counts towards le when it ends at or
+// below it, so the counts are exact to the perf resolution of about 20%.
+struct Limit {
+  const char *le;
+  uint32_t    us;
+};
+
+static const Limit LIMITS[] = {
+  { "0.0001", 100 },    { "0.0005", 500 },    { "0.001", 1000 },     { "0.005", 5000 },
+  { "0.01", 10000 },    { "0.05", 50000 },    { "0.1", 100000 },     { "0.5", 500000 },
+  { "1", 1000000 },     { "5", 5000000 },     { "10", 10000000 },
+};
+
+// Groups of lines, rendered whole. The perf sections follow.
+enum part_t { ptFan, ptTelegram, ptSystem, ptHistogramHelp, PT_COUNT };
+
+// ======== TYPES =====================
+// Appends to a fixed buffer, remembers when a line did not fit
+struct Output {
+  char  *data;
+  size_t size;
+  size_t length;
+  bool   full;
+};
+
+// ======== HELPERS ===================
+static void put(Output &out, const char *format, ...) {
+  if (out.full) return;
+
+  va_list args;
+  va_start(args, format);
+  int n = vsnprintf(out.data + out.length, out.size - out.length, format, args);
+  va_end(args);
+
+  if (n < 0 || (size_t)n >= out.size - out.length) out.full = true;
+  else out.length += n;
+}
+
+static void family(Output &out, const char *name, const char *type, const char *help) {
+  put(out, "# HELP bedroomfan_%s %s\n# TYPE bedroomfan_%s %s\n", name, help, name, type);
+}
+
+static void renderFan(Output &out) {
+  family(out, "relay_on", "gauge", "1 while the relay switches the fan on");
+  put(out, "bedroomfan_relay_on %d\n", fanIsOn() ? 1 : 0);
+  family(out, "relay_switches_total", "counter", "Changes of the relay state since boot");
+  put(out, "bedroomfan_relay_switches_total %u\n", fanSwitchCount());
+  family(out, "fan_on_seconds_total", "counter", "Time the fan was on since boot");
+  put(out, "bedroomfan_fan_on_seconds_total %u\n", fanOnSeconds());
+  family(out, "timer_remaining_seconds", "gauge", "Time until the timer switches the fan off");
+  uint32_t timerMs = (fanMode == fsTimer && fanIsOn() && !fanTimer.lapsed()) ? fanTimer.remaining() : 0;
+  put(out, "bedroomfan_timer_remaining_seconds %u\n", timerMs / 1000);
+
+  family(out, "mode", "gauge", "1 for the current mode of the fan");
+  const char *current = fanModeName();
+  for (const char *mode : MODES) {
+    put(out, "bedroomfan_mode{mode=\"%s\"} %d\n", mode, strcmp(mode, current) == 0 ? 1 : 0);
+  }
+}
+
+static void renderTelegram(Output &out) {
+  family(out, "telegram_requests_total", "counter", "Calls to the Telegram Bot API");
+  for (int call = 0; call < TC_COUNT; call++) {
+    put(out, "bedroomfan_telegram_requests_total{call=\"%s\"} %u\n",
+        telegramCallName((telegramCall_t)call), telegramRequests((telegramCall_t)call));
+  }
+  family(out, "telegram_errors_total", "counter", "Failed calls to the Telegram Bot API, polls are not counted");
+  for (int call = 0; call < TC_COUNT; call++) {
+    put(out, "bedroomfan_telegram_errors_total{call=\"%s\"} %u\n",
+        telegramCallName((telegramCall_t)call), telegramErrors((telegramCall_t)call));
+  }
+}
+
+static void renderSystem(Output &out) {
+  bool connected = halWifiConnected();
+  family(out, "wifi_connected", "gauge", "1 while WiFi is connected");
+  put(out, "bedroomfan_wifi_connected %d\n", connected ? 1 : 0);
+  if (connected) {
+    family(out, "wifi_rssi_dbm", "gauge", "WiFi signal strength");
+    put(out, "bedroomfan_wifi_rssi_dbm %d\n", halWifiRssi());
+  }
+  family(out, "wifi_reconnects_total", "counter", "WiFi reconnect attempts since boot");
+  put(out, "bedroomfan_wifi_reconnects_total %u\n", wifiReconnectCount());
+
+  family(out, "time_synced", "gauge", "1 after the first NTP sync");
+  put(out, "bedroomfan_time_synced %d\n", timeIsSynced() ? 1 : 0);
+  if (timeIsSynced()) {
+    family(out, "ntp_offset_seconds", "gauge", "Error of the corrected clock found at the last NTP sync");
+    put(out, "bedroomfan_ntp_offset_seconds %.3f\n", ntpOffsetMs() / 1000.0);
+  }
+
+  family(out, "heap_free_bytes", "gauge", "Free heap");
+  put(out, "bedroomfan_heap_free_bytes %u\n", ESP.getFreeHeap());
+  family(out, "heap_min_free_bytes", "gauge", "Lowest free heap since boot");
+  put(out, "bedroomfan_heap_min_free_bytes %u\n", ESP.getMinFreeHeap());
+  family(out, "heap_largest_block_bytes", "gauge", "Largest allocatable block");
+  put(out, "bedroomfan_heap_largest_block_bytes %u\n", ESP.getMaxAllocHeap());
+
+  const RemoteLogCounters &log = remoteLogCounters();
+  family(out, "syslog_records_total", "counter", "Event log records sent to the syslog collector");
+  put(out, "bedroomfan_syslog_records_total %u\n", log.records);
+  family(out, "syslog_lost_total", "counter", "Event log records lost before they were sent");
+  put(out, "bedroomfan_syslog_lost_total %u\n", log.lost);
+  family(out, "syslog_busy_total", "counter", "Datagrams the network stack did not take");
+  put(out, "bedroomfan_syslog_busy_total %u\n", log.busy);
+
+  family(out, "uptime_seconds", "gauge", "Time since boot");
+  put(out, "bedroomfan_uptime_seconds %.3f\n", halMicros() / 1e6);
+}
+
+// Section names are constants of the firmware, they need no escaping
+static void renderHistogram(Output &out, perf_t section) {
+  const char *name = perfSectionName(section);
+  for (const Limit &limit : LIMITS) {
+    put(out, "bedroomfan_section_seconds_bucket{section=\"%s\",le=\"%s\"} %u\n",
+        name, limit.le, perfCountAtMost(section, limit.us));
+  }
+  put(out, "bedroomfan_section_seconds_bucket{section=\"%s\",le=\"+Inf\"} %u\n", name, perfCount(section));
+  put(out, "bedroomfan_section_seconds_sum{section=\"%s\"} %.6f\n", name, perfSumUs(section) / 1e6);
+  put(out, "bedroomfan_section_seconds_count{section=\"%s\"} %u\n", name, perfCount(section));
+}
+
+static void renderPart(Output &out, uint32_t part) {
+  switch (part) {
+    case ptFan:           return renderFan(out);
+    case ptTelegram:      return renderTelegram(out);
+    case ptSystem:        return renderSystem(out);
+    case ptHistogramHelp: return family(out, "section_seconds", "histogram", "Duration of jobs and network calls");
+    default:              return renderHistogram(out, part - PT_COUNT);
+  }
+}
+
+// ======== PUBLIC API ================
+size_t prometheusRender(char *out, size_t size, uint32_t &cursor) {
+  Output output = { out, size, 0, false };
+
+  while (cursor < PT_COUNT + perfSectionCount()) {
+    size_t before = output.length;
+    renderPart(output, cursor);
+    if (output.full) {
+      output.length = before;
+      if (before > 0) break; // Continues in the next call
+      cursor++;              // Does not fit on its own, left out
+      output.full = false;
+      continue;
+    }
+    cursor++;
+  }
+  return output.length;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <Arduino.h>
+
+/*
+Device health in the Prometheus text exposition format, served by the HTTP
+server as GET /metrics.
+
+  bedroomfan_relay_on, _relay_switches_total, _fan_on_seconds_total
+  bedroomfan_mode{mode="clock"}              1 for the current mode
+  bedroomfan_telegram_requests_total{call=}  poll, send, edit, query
+  bedroomfan_telegram_errors_total{call=}
+  bedroomfan_section_seconds{section=}       histogram of every perf section
+  bedroomfan_wifi_rssi_dbm, _wifi_reconnects_total
+  bedroomfan_ntp_offset_seconds, _heap_*_bytes, _uptime_seconds
+  bedroomfan_syslog_records_total, _syslog_lost_total, _syslog_busy_total
+
+The text is rendered straight from the counters into the caller's buffer, a
+few lines at a time, so a scrape needs no heap and no buffer for the whole
+page. tools/scrape_metrics.py checks the format and times the scrapes.
+*/
+
+// ======== FUNCTIONS ================
+// Renders the next lines into out, returns their length and 0 at the end.
+// cursor starts at 0 and keeps the position between calls.
+size_t prometheusRender(char *out, size_t size, uint32_t &cursor);
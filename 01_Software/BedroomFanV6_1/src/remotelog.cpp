@@ -0,0 +1,147 @@
+#include "remotelog.h"
+
+#include <string.h>
+#include <time.h>
+
+#include "eventlog.h"
+#include "scheduler.h"
+#include "timefmt.h"
+#include "timer.h"
+#include "wifi_connect.h"
+#include "hal.h"
+#include "myCredentials.h"  // syslogCollector, syslogPort
+
+// ======== CONSTANTS =================
+constexpr uint16_t DEFAULT_PORT      = 514;
+constexpr uint32_t SEND_PERIOD       = 1 * MS_PER_SEC;
+constexpr uint32_t RESOLVE_RETRY     = 30 * MS_PER_SEC;
+constexpr size_t   DATAGRAM_SIZE     = 1024;            // Below the MTU, never fragmented
+constexpr size_t   DATAGRAMS_PER_RUN = EVENTLOG_SIZE;   // One message each, the rest waits for the next run
+constexpr uint32_t MAX_SEQUENCE_ID   = 2147483647;      // RFC 5424 sequenceId runs from 1 to this
+
+constexpr time_t   CLOCK_VALID_AFTER = 1451606400;      // 2016-01-01, earlier times are sent as "-"
+constexpr uint8_t  PRIORITY          = 16 * 8 + 6;      // Facility local0, severity informational
+
+static const char *HOSTNAME = "bedroomfan";
+static const char *APP_NAME = "fan";
+
+// ======== STATE =====================
+enum remoteLogState_t { rsOff, rsUnresolved, rsReady };
+
+struct RemoteLog {
+  const char      *host = nullptr;
+  uint16_t         port = DEFAULT_PORT;
+  remoteLogState_t state = rsOff;
+  uint32_t         resolveAt = 0;
+
+  uint32_t next = 0;    // Sequence number of the oldest record not sent yet
+  uint8_t  datagram[DATAGRAM_SIZE];
+
+  RemoteLogCounters counters = {};
+};
+
+static RemoteLog r;
+
+// ======== HELPERS ===================
+// Records the ring no longer holds are lost, the collector sees the gap
+static void skipLost() {
+  uint32_t newest = eventLogNextSequence();
+  if (newest - r.next > EVENTLOG_SIZE) {
+    r.counters.lost += newest - r.next - EVENTLOG_SIZE;
+    r.next = newest - EVENTLOG_SIZE;
+  }
+
+  time_t when;
+  const char *text;
+  while (r.next != newest && !eventLogRecord(r.next, when, text)) {
+    r.counters.lost++;
+    r.next++;
+  }
+}
+
+// RFC 5426: one message per datagram, a message that does not fit is cut short.
+// Returns the length.
+static size_t formatRecord(uint32_t sequence, time_t when, const char *text) {
+  char stamp[24] = "-";
+  if (when >= CLOCK_VALID_AFTER) {
+    struct tm utc;
+    gmtime_r(&when, &utc);
+    TimestampText t = formatTimestamp(utc);
+    t.text[10] = 'T';
+    snprintf(stamp, sizeof(stamp), "%sZ", t.c_str());
+  }
+
+  char *out = (char *)r.datagram;
+  int n = snprintf(out, DATAGRAM_SIZE, "<%u>1 %s %s %s - - [meta sequenceId=\"%u\"] %s",
+                   PRIORITY, stamp, HOSTNAME, APP_NAME, sequence % MAX_SEQUENCE_ID + 1, text);
+  if (n < 0) return 0;
+  if ((size_t)n >= DATAGRAM_SIZE) n = DATAGRAM_SIZE - 1;
+
+  // One line per message in the files of the collector
+  for (int i = 0; i < n; i++) if (out[i] == '\n') out[i] = ' ';
+  return n;
+}
+
+// ======== PUBLIC API ================
+void remoteLogSetCollector(const char *host, uint16_t port) {
+  r.host = host;
+  r.port = port;
+}
+
+void setupRemoteLog() {
+#ifdef syslogCollector
+  if (r.host == nullptr) r.host = syslogCollector;
+#ifdef syslogPort
+  r.port = syslogPort;
+#endif
+#endif
+  if (r.host == nullptr) return;
+
+  // Starts with the records of the boot that are still in the ring
+  r.state = rsUnresolved;
+  addPeriodicJob("syslog", loopRemoteLog, SEND_PERIOD, jpHousekeeping, 20);
+}
+
+void loopRemoteLog() {
+  if (r.state == rsOff || !wifiIsConnected()) return;
+
+  if (r.state == rsUnresolved) {
+    if ((int32_t)(halMillis() - r.resolveAt) < 0) return;
+    if (!halUdpBegin(r.host, r.port)) {
+      r.resolveAt = halMillis() + RESOLVE_RETRY;
+      return;
+    }
+    r.state = rsReady;
+  }
+
+  for (size_t i = 0; i < DATAGRAMS_PER_RUN; i++) {
+    skipLost();
+
+    time_t when;
+    const char *text;
+    if (r.next == eventLogNextSequence() || !eventLogRecord(r.next, when, text)) return;
+
+    size_t length = formatRecord(r.next, when, text);
+    if (length == 0 || !halUdpSend(r.datagram, length)) {
+      r.counters.busy++; // The record stays in the ring for the next run
+      return;
+    }
+    r.next++;
+    r.counters.records++;
+    r.counters.datagrams++;
+  }
+}
+
+const RemoteLogCounters &remoteLogCounters() {
+  return r.counters;
+}
+
+String remoteLogStatus() {
+  if (r.state == rsOff) return "Remote log off";
+
+  char text[128];
+  snprintf(text, sizeof(text), "Remote log to %s:%u%s, %u records in %u datagrams, %u lost, %u busy",
+           r.host, r.port, r.state == rsUnresolved ? " (unresolved)" : "",
+           r.counters.records, r.counters.datagrams, r.counters.lost, r.counters.busy);
+  return String(text);
+}
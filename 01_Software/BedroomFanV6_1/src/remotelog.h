@@ -0,0 +1,41 @@
+#pragma once
+
+#include <Arduino.h>
+
+/*
+Remote log: the event log sent to a syslog collector over UDP.
+
+New records are sent once a second, one RFC 5424 message per datagram of
+up to 1 kB as RFC 5426 requires, so rsyslog, syslog-ng and other standard
+collectors read each record on its own:
+
+  <134>1 2025-07-01T18:30:00Z bedroomfan fan - - [meta sequenceId="42"] Fan switched on by ...
+
+Every record carries its event log sequence number (plus one), so the
+collector sees a gap wherever records were lost. The records wait in the
+event log ring until their datagram was taken by the network stack;
+nothing is copied and a send never waits. When the stack is full or WiFi is
+down, the next run tries again, and records the ring overwrote meanwhile
+are counted as lost. tools/syslog_listen.py receives and checks the
+datagrams.
+
+The collector comes from myCredentials.h, without it the remote log is off:
+
+  #define syslogCollector "192.168.1.10"  // An address needs no DNS lookup
+  #define syslogPort 514                  // optional
+*/
+
+// ======== TYPES ================
+struct RemoteLogCounters {
+  uint32_t records;   // Sent
+  uint32_t datagrams;
+  uint32_t lost;      // Overwritten or cleared before they were sent
+  uint32_t busy;      // Sends the network stack did not take
+};
+
+// ======== FUNCTIONS ================
+void setupRemoteLog();
+void loopRemoteLog();
+void remoteLogSetCollector(const char *host, uint16_t port); // Instead of myCredentials.h, before setupRemoteLog()
+const RemoteLogCounters &remoteLogCounters();
+String remoteLogStatus();
@@ -0,0 +1,149 @@
+#include "rtcstate.h"
+
+#include <esp_timer.h>
+#include <rom/crc.h>
+#include <sys/time.h>
+
+#include "timer.h"
+#include "fancontrol.h"
+#include "timesync.h"
+
+// ======== CONSTANTS =================
+constexpr uint32_t SNAPSHOT_MAGIC    = 0x46414e31; // "FAN1", bump when the layout changes
+constexpr uint32_t SNAPSHOT_INTERVAL = 10 * MS_PER_SEC;
+constexpr uint32_t RESET_DURATION    = 1 * MS_PER_SEC; // Assumed time lost in the reset itself
+
+// ======== TYPES =====================
+struct StateSnapshot {
+  uint32_t magic;
+  uint32_t sequence;
+
+  // Fan
+  uint8_t  mode;
+  uint8_t  timerDuration;
+  uint8_t  fanOn;
+  uint8_t  timeSource;
+  uint32_t timerRemaining;  // [ms]
+  uint16_t clockOn;         // Minutes after midnight
+  uint16_t clockOff;
+
+  // Clock: epoch at the snapshot and the esp_timer value it belongs to
+  int64_t  epochUs;
+  int64_t  monoUs;
+  uint32_t uncertaintyMs;
+
+  uint32_t crc;
+};
+
+// ======== STATE =====================
+RTC_NOINIT_ATTR static StateSnapshot slots[2];
+
+static uint8_t nextSlot = 0;
+static uint32_t sequence = 0;
+static bool restoring = false; // The fan calls saveStateSnapshot() on every step of the restore
+
+// ======== HELPERS ===================
+static uint32_t snapshotCrc(const StateSnapshot &s) {
+  return crc32_le(0, (const uint8_t *)&s, offsetof(StateSnapshot, crc));
+}
+
+static bool snapshotValid(const StateSnapshot &s) {
+  return s.magic == SNAPSHOT_MAGIC && s.crc == snapshotCrc(s);
+}
+
+// Newest valid slot, or -1
+static int newestSlot() {
+  bool valid0 = snapshotValid(slots[0]);
+  bool valid1 = snapshotValid(slots[1]);
+
+  if (valid0 && valid1) return (int32_t)(slots[1].sequence - slots[0].sequence) > 0 ? 1 : 0;
+  if (valid0) return 0;
+  if (valid1) return 1;
+  return -1;
+}
+
+static void restoreClock(const StateSnapshot &s) {
+  if (s.timeSource == tsNone) return;
+
+  struct timeval tv;
+  gettimeofday(&tv, nullptr);
+  if (tv.tv_sec > 1600000000) {
+    // The system clock kept running over the reset
+    offerTime(tsRestored, tv.tv_sec, s.uncertaintyMs + RESET_DURATION);
+    return;
+  }
+
+  // The snapshot is at most one interval old, esp_timer counts from the reset
+  int64_t epochUs = s.epochUs + (int64_t)SNAPSHOT_INTERVAL * 500 + esp_timer_get_time();
+  offerTime(tsRestored, epochUs / 1000000, s.uncertaintyMs + SNAPSHOT_INTERVAL / 2 + RESET_DURATION);
+}
+
+// ======== PUBLIC API ================
+void saveStateSnapshot() {
+  if (restoring) return;
+  StateSnapshot &s = slots[nextSlot];
+
+  s.magic          = SNAPSHOT_MAGIC;
+  s.sequence       = ++sequence;
+  s.mode           = fanMode;
+  s.timerDuration  = timerDuration;
+  s.fanOn          = fanIsOn();
+  s.timerRemaining = (fanMode == fsTimer) ? fanTimer.remaining() : 0;
+  s.clockOn        = clock_on.minutes_after_midnight;
+  s.clockOff       = clock_off.minutes_after_midnight;
+
+  struct timeval tv;
+  gettimeofday(&tv, nullptr);
+  s.timeSource     = timeSource();
+  s.epochUs        = (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+  s.monoUs         = esp_timer_get_time();
+  s.uncertaintyMs  = timeUncertaintyMs();
+
+  s.crc = snapshotCrc(s);
+  nextSlot ^= 1;
+}
+
+bool restoreStateSnapshot() {
+  int slot = newestSlot();
+  if (slot < 0) return false;
+
+  const StateSnapshot &s = slots[slot];
+  sequence = s.sequence;
+  nextSlot = slot ^ 1;
+  restoring = true;
+
+  // Only sets the system time, before anything reads it
+  restoreClock(s);
+
+  clock_on.minutes_after_midnight  = s.clockOn;
+  clock_off.minutes_after_midnight = s.clockOff;
+  clock_on.range_check();
+  clock_off.range_check();
+
+  // Relay first, then the mode
+  if (s.fanOn) switchOnFan();
+  else switchOffFan();
+
+  switch (s.mode) {
+    case fsOn:    setFanModeOn();    break;
+    case fsOff:   setFanModeOff();   break;
+    case fsClock: setFanModeClock(); break;
+    case fsTimer:
+      if (s.timerRemaining > 0 && s.timerRemaining <= 240 * MS_PER_MIN) {
+        setFanModeTimer(tTimerDuration(s.timerDuration));
+        fanTimer.interval = s.timerRemaining;
+      } else {
+        setFanModeClock();
+      }
+      break;
+  }
+
+  // One snapshot of the restored state, with the time source and the timer remaining
+  restoring = false;
+  saveStateSnapshot();
+  return true;
+}
+
+void loopStateSnapshot() {
+  saveStateSnapshot();
+}
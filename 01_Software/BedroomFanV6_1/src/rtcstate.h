@@ -0,0 +1,16 @@
+#pragma once
+
+#include <Arduino.h>
+
+/*
+Snapshot of the fan state and the clock in RTC slow memory.
+
+RTC memory keeps its contents over a soft reset, crash or watchdog reset,
+but not over a power cycle. The snapshot is written to two slots in turn,
+each with a sequence number and CRC, so a reset halfway a write always
+leaves one valid copy.
+*/
+
+void saveStateSnapshot();    // Write the current state, cheap enough to call on every change
+bool restoreStateSnapshot(); // Apply the newest valid snapshot, returns false if there is none
+void loopStateSnapshot();    // Periodic snapshot every 10 s, keeps the timer and clock up to date
@@ -0,0 +1,159 @@
+#include "scheduler.h"
+
+#include <esp_timer.h>
+
+#include "eventlog.h"
+#include "localclock.h"
+#include "perf.h"
+#include "hal.h"
+
+// ======== CONSTANTS =================
+constexpr size_t   MAX_JOBS  = 16;
+constexpr uint32_t MAX_SLEEP = 1000; // [ms] Upper bound on one sleep
+
+// ======== TYPES =====================
+struct Job {
+  const char   *name;
+  jobFunction_t function;
+  uint32_t      period;    // 0 for a deadline job
+  jobPriority_t priority;
+  uint32_t      budgetUs;
+  perf_t        perf;      // Latency histogram
+  bool          network;   // Woken by network input
+
+  bool          armed;
+  uint32_t      due;       // millis() of the next run
+
+  uint32_t      runs;
+  uint32_t      overruns;
+  uint32_t      wcetUs;    // Worst case execution time
+  uint64_t      totalUs;
+};
+
+// ======== STATE =====================
+static Job jobs[MAX_JOBS];
+static size_t jobCount = 0;
+
+// ======== HELPERS ===================
+static bool isDue(const Job &job, uint32_t now) {
+  return job.armed && (int32_t)(job.due - now) <= 0;
+}
+
+static job_t addJob(const char *name, jobFunction_t function, uint32_t period,
+                    jobPriority_t priority, uint32_t budgetMs) {
+  if (jobCount >= MAX_JOBS) {
+    Serial.printf("Too many jobs, %s not added\n", name);
+    return NO_JOB;
+  }
+
+  Job &job = jobs[jobCount];
+  memset(&job, 0, sizeof(job));
+  job.name     = name;
+  job.function = function;
+  job.period   = period;
+  job.priority = priority;
+  job.budgetUs = budgetMs * 1000;
+  job.perf     = perfSection(name);
+  job.armed    = period > 0;
+  job.due      = millis();
+
+  return jobCount++;
+}
+
+// Highest priority job that is due, earliest deadline first within a priority
+static Job *nextDueJob(uint32_t now) {
+  Job *best = nullptr;
+  for (size_t i = 0; i < jobCount; i++) {
+    Job &job = jobs[i];
+    if (!isDue(job, now)) continue;
+    if (best == nullptr || job.priority < best->priority ||
+        (job.priority == best->priority && (int32_t)(job.due - best->due) < 0)) {
+      best = &job;
+    }
+  }
+  return best;
+}
+
+static void runJob(Job &job) {
+  uint32_t due = job.due;
+
+  if (job.period > 0) {
+    job.due = due + job.period;
+    // Fallen behind more than a period: skip the missed runs
+    if ((int32_t)(job.due - millis()) < 0) job.due = millis() + job.period;
+  } else {
+    job.armed = false; // The job may schedule itself again
+  }
+
+  localClockTick(); // One "now" for everything the job does
+  int64_t start = esp_timer_get_time();
+  job.function();
+  uint32_t elapsed = esp_timer_get_time() - start;
+
+  job.runs++;
+  job.totalUs += elapsed;
+  perfRecord(job.perf, elapsed);
+
+  if (elapsed > job.budgetUs) {
+    job.overruns++;
+    if (elapsed > job.wcetUs) {
+      addToEventLogf("Job %s overran: %u ms, budget %u ms", job.name, elapsed / 1000, job.budgetUs / 1000);
+    }
+  }
+  if (elapsed > job.wcetUs) job.wcetUs = elapsed;
+}
+
+// ======== PUBLIC API ================
+job_t addPeriodicJob(const char *name, jobFunction_t function, uint32_t periodMs,
+                     jobPriority_t priority, uint32_t budgetMs) {
+  return addJob(name, function, max(periodMs, (uint32_t)1), priority, budgetMs);
+}
+
+job_t addDeadlineJob(const char *name, jobFunction_t function,
+                     jobPriority_t priority, uint32_t budgetMs) {
+  return addJob(name, function, 0, priority, budgetMs);
+}
+
+void scheduleJob(job_t job, uint32_t delayMs) {
+  if (job < 0 || (size_t)job >= jobCount) return;
+  jobs[job].due = millis() + delayMs;
+  jobs[job].armed = true;
+}
+
+void wakeOnNetwork(job_t job) {
+  if (job < 0 || (size_t)job >= jobCount) return;
+  jobs[job].network = true;
+}
+
+void runScheduler() {
+  Job *job;
+  while ((job = nextDueJob(millis())) != nullptr) runJob(*job);
+
+  // Sleep until the next deadline
+  uint32_t now = millis();
+  uint32_t sleep = MAX_SLEEP;
+  for (size_t i = 0; i < jobCount; i++) {
+    if (!jobs[i].armed) continue;
+    int32_t remaining = (int32_t)(jobs[i].due - now);
+    if (remaining <= 0) return;
+    sleep = min(sleep, (uint32_t)remaining);
+  }
+  if (!halNetWait(sleep)) return;
+  for (size_t i = 0; i < jobCount; i++) {
+    if (jobs[i].network) scheduleJob(i, 0);
+  }
+}
+
+String schedulerReport() {
+  String result = "Job: runs, overruns, avg/worst ms\n";
+  char line[80];
+
+  for (size_t i = 0; i < jobCount; i++) {
+    const Job &job = jobs[i];
+    uint32_t average = job.runs ? job.totalUs / job.runs : 0;
+    snprintf(line, sizeof(line), "%s: %u, %u, %.1f/%.1f\n", job.name, job.runs, job.overruns,
+             average / 1000.0f, job.wcetUs / 1000.0f);
+    result += line;
+  }
+  return result;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <Arduino.h>
+
+/*
+Cooperative job scheduler.
+
+Modules register their jobs in their setup function. A periodic job runs
+every period, a deadline job runs once each time it is scheduled. When no
+job is due, runScheduler() sleeps until the next deadline, so the CPU can
+slow down or sleep in between. Network input ends the sleep early and runs
+the jobs registered with wakeOnNetwork(), so servers need not poll.
+
+Each job has a priority (0 is highest) and a time budget. Runs that exceed
+the budget are counted and logged, and the worst case execution time is kept.
+*/
+
+// ======== TYPES ================
+typedef void (*jobFunction_t)();
+typedef int8_t job_t;
+
+constexpr job_t NO_JOB = -1;
+
+enum jobPriority_t { jpRelay, jpNetwork, jpControl, jpHousekeeping };
+
+// ======== FUNCTIONS ================
+job_t addPeriodicJob(const char *name, jobFunction_t function, uint32_t periodMs,
+                     jobPriority_t priority, uint32_t budgetMs);
+job_t addDeadlineJob(const char *name, jobFunction_t function,
+                     jobPriority_t priority, uint32_t budgetMs);
+void scheduleJob(job_t job, uint32_t delayMs); // Run a job after delayMs, replaces an earlier deadline
+void wakeOnNetwork(job_t job);                 // Run a job at once when a socket of hal.h has input
+
+void runScheduler();      // Call from loop()
+String schedulerReport(); // Run count, overruns and worst case execution time per job
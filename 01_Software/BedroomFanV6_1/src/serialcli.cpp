@@ -0,0 +1,122 @@
+#include "serialcli.h"
+
+#include <string.h>
+#include <stdlib.h>
+
+#include "commandbus.h"
+#include "fancontrol.h"
+#include "metrics.h"
+#include "scheduler.h"
+
+// ======== CONSTANTS =================
+constexpr size_t   MAX_LINE = 64;
+constexpr uint32_t POLL_PERIOD = 500; // [ms] A typed line fits the 256 byte UART buffer
+
+static const char *USER = "console";
+
+static const char *HELP =
+  "on | off | clock | timer 20|60|240\n"
+  "clock on <+-minutes> | clock off <+-minutes>\n"
+  "status | info | health [metric] | jobs | power | perf\n"
+  "log | log clear\n";
+
+// Words that map to a command without an argument
+struct Word {
+  const char *text;
+  command_t   command;
+};
+
+static const Word WORDS[] = {
+  { "on",        cmFanOn         },
+  { "off",       cmFanOff        },
+  { "clock",     cmFanClock      },
+  { "status",    cmStatus        },
+  { "info",      cmInfo          },
+  { "jobs",      cmJobs          },
+  { "power",     cmPower         },
+  { "perf",      cmPerf          },
+  { "log",       cmEventLog      },
+  { "log clear", cmEventLogClear },
+};
+
+// ======== STATE =====================
+static char line[MAX_LINE + 1];
+static size_t lineLength = 0;
+static bool overflow = false;
+
+// ======== HELPERS ===================
+static void printResult(const Command &, const String &result) {
+  Serial.print(result);
+  if (!result.endsWith("\n")) Serial.println();
+}
+
+static void post(command_t type, int32_t argument = 0) {
+  Command command;
+  command.type     = type;
+  command.argument = argument;
+  command.origin   = coSerial;
+  command.user     = USER;
+  command.reply    = printResult;
+  if (!postCommand(command)) Serial.println("Busy, try again");
+}
+
+// true if text starts with word followed by a space
+static bool hasPrefix(const char *text, const char *word) {
+  size_t n = strlen(word);
+  return strncmp(text, word, n) == 0 && text[n] == ' ';
+}
+
+static void handleLine(const char *text) {
+  while (*text == ' ') text++;
+  if (*text == '\0') return;
+
+  for (const Word &w : WORDS) {
+    if (strcmp(text, w.text) == 0) {
+      post(w.command);
+      return;
+    }
+  }
+
+  if (hasPrefix(text, "timer")) {
+    int minutes = atoi(text + 6);
+    if      (minutes == 20)  post(cmFanTimer, tdTimer20);
+    else if (minutes == 60)  post(cmFanTimer, tdTimer60);
+    else if (minutes == 240) post(cmFanTimer, tdTimer240);
+    else Serial.println("Timer is 20, 60 or 240 minutes");
+  }
+  else if (hasPrefix(text, "clock on"))  post(cmClockOnShift,  atoi(text + 9));
+  else if (hasPrefix(text, "clock off")) post(cmClockOffShift, atoi(text + 10));
+  else if (hasPrefix(text, "health")) {
+    metric_t metric;
+    if (metricFromName(text + 7, metric)) post(cmHealth, metric);
+    else Serial.println("Unknown metric");
+  }
+  else if (strcmp(text, "health") == 0) post(cmHealth, -1);
+  else if (strcmp(text, "help") == 0)   Serial.print(HELP);
+  else {
+    Serial.print("Unknown command: ");
+    Serial.println(text);
+  }
+}
+
+// ======== PUBLIC API ================
+void setupSerialCli() {
+  addPeriodicJob("serial", loopSerialCli, POLL_PERIOD, jpControl, 5);
+}
+
+void loopSerialCli() {
+  while (Serial.available() > 0) {
+    char c = Serial.read();
+    if (c == '\r') continue;
+
+    if (c == '\n') {
+      line[lineLength] = '\0';
+      if (overflow) Serial.println("Line too long");
+      else handleLine(line);
+      lineLength = 0;
+      overflow = false;
+    }
+    else if (lineLength < MAX_LINE) line[lineLength++] = c;
+    else overflow = true;
+  }
+}
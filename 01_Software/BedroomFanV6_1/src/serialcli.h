@@ -0,0 +1,22 @@
+#pragma once
+
+#include <Arduino.h>
+
+/*
+Command line on the serial console.
+
+A front end of the command bus that works without the network, at the
+speed of the wire. One command per line, the result is printed back:
+
+  on | off | clock          fan mode
+  timer 20 | 60 | 240       fan on for a while
+  clock on +15, clock off -60  move one end of the clock window [min]
+  status | info | jobs | power | perf
+  health [metric]
+  log | log clear
+  help
+*/
+
+// ======== FUNCTIONS ================
+void setupSerialCli();
+void loopSerialCli();
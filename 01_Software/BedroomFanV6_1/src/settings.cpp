@@ -0,0 +1,142 @@
+#include "settings.h"
+
+#include <Preferences.h>
+
+#include "timer.h"
+#include "eventlog.h"
+#include "fancontrol.h"
+
+// ======== CONSTANTS =================
+constexpr uint8_t  SETTINGS_VERSION = 1;
+constexpr uint32_t QUIET_PERIOD     = 30 * MS_PER_SEC; // Write after no changes for this long
+
+constexpr const char *NVS_NAMESPACE = "bedroomfan";
+constexpr const char *NVS_KEY       = "settings";
+
+// ======== TYPES =====================
+// Schema rules: only append fields. A blob from an older version is read over
+// the defaults, so new fields keep their default value. Fields that change
+// meaning need a conversion in migrate().
+struct __attribute__((packed)) SettingsBlob {
+  uint8_t  version;
+  uint8_t  mode;
+  uint8_t  timerDuration;
+  uint16_t clockOn;         // Minutes after midnight
+  uint16_t clockOff;
+  uint32_t timerRemaining;  // [ms] when the timer was running at the last write
+  uint32_t writes;          // Lifetime write count, stored in the blob to save a write
+};
+
+// ======== STATE =====================
+static SettingsBlob stored;           // Last blob read from or written to NVS
+static bool dirty = false;
+static bool immediateWrite = false;
+static milliSecTimer quiet(QUIET_PERIOD, false);
+
+// ======== HELPERS ===================
+static SettingsBlob defaults() {
+  SettingsBlob blob;
+  memset(&blob, 0, sizeof(blob));
+  blob.version       = SETTINGS_VERSION;
+  blob.mode          = fsClock;
+  blob.timerDuration = tdTimer20;
+  blob.clockOn       = 16 * 60 + 30;
+  blob.clockOff      = 22 * 60;
+  return blob;
+}
+
+static void migrate(SettingsBlob &blob) {
+  switch (blob.version) {
+    // case 1: conversions from version 1 to 2 go here, and fall through
+    default:
+      break;
+  }
+  blob.version = SETTINGS_VERSION;
+}
+
+static SettingsBlob currentSettings() {
+  SettingsBlob blob = stored;
+  blob.version        = SETTINGS_VERSION;
+  blob.mode           = fanMode;
+  blob.timerDuration  = timerDuration;
+  blob.clockOn        = clock_on.minutes_after_midnight;
+  blob.clockOff       = clock_off.minutes_after_midnight;
+  blob.timerRemaining = (fanMode == fsTimer && fanIsOn()) ? fanTimer.remaining() : 0;
+  return blob;
+}
+
+static void writeSettings() {
+  SettingsBlob blob = currentSettings();
+  dirty = false;
+  immediateWrite = false;
+
+  // A running timer keeps counting down, that alone is no reason to write
+  if (blob.timerRemaining > 0 && stored.timerRemaining > 0) blob.timerRemaining = stored.timerRemaining;
+  bool changed = memcmp(&blob, &stored, sizeof(blob)) != 0;
+  if (!changed) return;
+
+  blob = currentSettings();
+  blob.writes = stored.writes + 1;
+
+  Preferences prefs;
+  if (!prefs.begin(NVS_NAMESPACE, false)) {
+    addToEventLog("Settings could not be saved");
+    return;
+  }
+  prefs.putBytes(NVS_KEY, &blob, sizeof(blob));
+  prefs.end();
+
+  stored = blob;
+}
+
+// ======== PUBLIC API ================
+void markSettingsDirty(bool immediate) {
+  dirty = true;
+  immediateWrite |= immediate;
+  quiet.reset();
+}
+
+bool loadSettings() {
+  stored = defaults();
+
+  Preferences prefs;
+  if (!prefs.begin(NVS_NAMESPACE, true)) return false;
+  SettingsBlob blob = defaults();
+  size_t len = prefs.getBytes(NVS_KEY, &blob, sizeof(blob));
+  prefs.end();
+
+  if (len == 0) return false;
+  migrate(blob);
+  stored = blob;
+  return true;
+}
+
+void applySettings() {
+  clock_on.minutes_after_midnight  = stored.clockOn;
+  clock_off.minutes_after_midnight = stored.clockOff;
+  clock_on.range_check();
+  clock_off.range_check();
+
+  switch (stored.mode) {
+    case fsOn:  setFanModeOn();  break;
+    case fsOff: setFanModeOff(); break;
+    case fsTimer:
+      if (stored.timerRemaining > 0 && stored.timerRemaining <= 240 * MS_PER_MIN) {
+        setFanModeTimer(tTimerDuration(stored.timerDuration));
+        fanTimer.interval = stored.timerRemaining;
+        break;
+      }
+      [[fallthrough]]; // The timer had already lapsed
+    default:
+      setFanModeClock();
+      break;
+  }
+}
+
+void loopSettings() {
+  if (dirty && (immediateWrite || quiet.lapsed())) writeSettings();
+}
+
+uint32_t settingsWriteCount() {
+  return stored.writes;
+}
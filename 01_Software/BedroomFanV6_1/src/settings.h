@@ -0,0 +1,18 @@
+#pragma once
+
+#include <Arduino.h>
+
+/*
+User settings in NVS: fan mode, timer and clock window.
+
+Settings are stored as one small binary blob with a schema version. Changes
+are only marked dirty and written after a quiet period, so tapping through
+the clock menu costs one flash write instead of dozens. A mode change is
+written at once.
+*/
+
+void markSettingsDirty(bool immediate = false); // immediate: write on the next loopSettings()
+bool loadSettings();                            // Single NVS read at boot, false if nothing stored
+void applySettings();                           // Set fan mode and clock from the loaded settings
+void loopSettings();
+uint32_t settingsWriteCount();                  // Number of NVS writes over the device lifetime
@@ -0,0 +1,62 @@
+#pragma once
+
+// Generated from web/status.html by tools/embed_page.py, do not edit
+
+#include <stdint.h>
+#include <stddef.h>
+
+constexpr char STATUS_PAGE_ETAG[] = "\"c877b99e6b076541\"";
+
+constexpr size_t STATUS_PAGE_SIZE = 770;
+
+const uint8_t STATUS_PAGE_GZIP[STATUS_PAGE_SIZE] = {
+  0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x9d, 0x55, 0x51, 0x4f, 0xdb, 0x30,
+  0x10, 0x7e, 0xef, 0xaf, 0xb8, 0x65, 0xd2, 0x92, 0x8a, 0x36, 0x69, 0x2b, 0x40, 0xa8, 0x4d, 0x82,
+  0xc4, 0xc6, 0x34, 0xa4, 0x6d, 0x20, 0x8d, 0x97, 0x3d, 0x21, 0x13, 0xdb, 0x8d, 0x47, 0x62, 0x57,
+  0xb6, 0xdb, 0xd2, 0x21, 0xfe, 0xfb, 0xee, 0x92, 0x52, 0xa0, 0x1a, 0xa2, 0xf0, 0x12, 0xdb, 0x77,
+  0xdf, 0xf7, 0x9d, 0xef, 0x72, 0xb9, 0xa4, 0x1f, 0xbe, 0x9c, 0x7f, 0xbe, 0xfc, 0x7d, 0x71, 0x0a,
+  0xa5, 0xaf, 0xab, 0xbc, 0x93, 0xd2, 0x02, 0x15, 0xd3, 0xd3, 0x2c, 0x10, 0x3a, 0x20, 0x83, 0x60,
+  0x1c, 0x97, 0x5a, 0x78, 0x06, 0x45, 0xc9, 0xac, 0x13, 0x3e, 0x0b, 0xe6, 0x5e, 0xf6, 0x8f, 0x82,
+  0x07, 0xb3, 0x66, 0xb5, 0xc8, 0x82, 0x85, 0x12, 0xcb, 0x99, 0xb1, 0x3e, 0x80, 0xc2, 0x68, 0x2f,
+  0x34, 0xc2, 0x96, 0x8a, 0xfb, 0x32, 0xe3, 0x62, 0xa1, 0x0a, 0xd1, 0x6f, 0x0e, 0x3d, 0x50, 0x5a,
+  0x79, 0xc5, 0xaa, 0xbe, 0x2b, 0x58, 0x25, 0xb2, 0x21, 0x89, 0x78, 0xe5, 0x2b, 0x91, 0x9f, 0x08,
+  0x6e, 0x8d, 0xa9, 0x41, 0x32, 0x9d, 0x26, 0xad, 0xa9, 0x93, 0x3a, 0xbf, 0xa2, 0xf5, 0xda, 0xf0,
+  0x15, 0xdc, 0x81, 0x44, 0xe1, 0xbe, 0x64, 0xb5, 0xaa, 0x56, 0x63, 0x70, 0x4c, 0xbb, 0xbe, 0x13,
+  0x56, 0xc9, 0x09, 0xd4, 0xec, 0xb6, 0xd5, 0x1f, 0xc3, 0xe8, 0x50, 0xd4, 0x64, 0xb0, 0x53, 0xa5,
+  0xc7, 0x30, 0x14, 0x35, 0xb0, 0xb9, 0x37, 0x13, 0x98, 0x31, 0xce, 0x95, 0x9e, 0x8e, 0x61, 0x40,
+  0xc6, 0x09, 0xdc, 0x77, 0xca, 0xe1, 0x83, 0xa4, 0x53, 0x7f, 0x05, 0x62, 0xe3, 0xfd, 0xd6, 0x71,
+  0x3d, 0xf7, 0xde, 0xe8, 0x2d, 0xe7, 0x53, 0xd5, 0x78, 0x44, 0xa7, 0x8d, 0x62, 0x7c, 0x80, 0x51,
+  0xe2, 0xa3, 0x96, 0xfc, 0xd1, 0x79, 0xe6, 0xc5, 0xb6, 0xf2, 0x68, 0xfb, 0x52, 0x03, 0xc2, 0xc6,
+  0xd6, 0x2c, 0x11, 0xb9, 0x91, 0x3d, 0x7c, 0x70, 0xa4, 0xc9, 0x3a, 0xf1, 0x34, 0x59, 0xd7, 0x9f,
+  0x2a, 0x40, 0x6f, 0x63, 0xf8, 0xbc, 0x4e, 0x78, 0xee, 0xa4, 0x5c, 0x2d, 0x40, 0xf1, 0x2c, 0x68,
+  0x22, 0x07, 0x79, 0x1c, 0xc7, 0x69, 0x82, 0xb6, 0xb5, 0xa7, 0xa8, 0x98, 0x73, 0x59, 0x80, 0xa1,
+  0xb0, 0xd6, 0x00, 0xe9, 0x3a, 0x3b, 0xa3, 0x8b, 0x4a, 0x15, 0x37, 0x59, 0x30, 0x33, 0xce, 0x47,
+  0x21, 0xaa, 0x25, 0x46, 0x87, 0xdd, 0x20, 0xff, 0xca, 0xc8, 0x99, 0x26, 0x2d, 0xee, 0x35, 0x8a,
+  0x94, 0x1b, 0x8e, 0x94, 0x3b, 0x92, 0x8a, 0xca, 0x14, 0x37, 0x44, 0xfb, 0x4c, 0x9b, 0x47, 0xd2,
+  0xfb, 0x6e, 0xed, 0x55, 0x2d, 0x6c, 0x32, 0x1a, 0x90, 0xe0, 0x68, 0x00, 0xb5, 0xda, 0xf5, 0xee,
+  0x2d, 0xf1, 0xb0, 0x21, 0x0e, 0xa1, 0x34, 0x73, 0xfb, 0x26, 0xe2, 0x68, 0xbf, 0x61, 0xee, 0x37,
+  0x4c, 0xb7, 0x53, 0x16, 0xe7, 0xfa, 0x25, 0xd9, 0xa6, 0x24, 0xf8, 0x02, 0x8e, 0x5d, 0xa9, 0xa4,
+  0xcf, 0xfa, 0xc3, 0x03, 0xd2, 0xc6, 0x65, 0xa3, 0xbb, 0x1b, 0xb1, 0xe5, 0xed, 0x3d, 0xe1, 0x51,
+  0x58, 0x29, 0x5f, 0x89, 0x2b, 0xe5, 0x7b, 0x03, 0x6f, 0x98, 0xff, 0x89, 0xfc, 0x52, 0x25, 0x52,
+  0x06, 0xa5, 0x15, 0x32, 0x0b, 0x12, 0x36, 0x53, 0x89, 0x58, 0xe0, 0xac, 0xa8, 0xcc, 0x34, 0xc8,
+  0x4f, 0x69, 0x07, 0xb8, 0x4d, 0x13, 0x96, 0xc3, 0xa7, 0x5a, 0x71, 0x6e, 0xfc, 0x04, 0x9e, 0xc3,
+  0x95, 0x96, 0x26, 0xc8, 0xcf, 0xf0, 0x49, 0xa8, 0x87, 0x10, 0xae, 0xb0, 0x6a, 0xe6, 0xf3, 0x8e,
+  0x9c, 0xeb, 0xc2, 0x2b, 0xbc, 0xad, 0x2b, 0xcd, 0x32, 0x72, 0x5d, 0xb8, 0xc3, 0xfc, 0x17, 0xcc,
+  0x82, 0x17, 0xb7, 0x1e, 0x32, 0x08, 0xa9, 0x53, 0x95, 0x83, 0x10, 0xf6, 0x20, 0x72, 0xb1, 0x15,
+  0x15, 0x5b, 0x41, 0x86, 0xf6, 0xf3, 0x9f, 0x21, 0x1c, 0x43, 0x88, 0x9f, 0x00, 0x8c, 0x71, 0xa1,
+  0xb6, 0x46, 0x48, 0xd8, 0x83, 0xda, 0x70, 0xd1, 0xc0, 0x5d, 0x4c, 0xdb, 0x09, 0xea, 0x29, 0x49,
+  0xdc, 0xa6, 0x0b, 0xae, 0xac, 0xa8, 0x19, 0x8e, 0x34, 0x3d, 0x85, 0x1c, 0x06, 0xdd, 0x36, 0xcc,
+  0x5e, 0x46, 0xc4, 0x96, 0xb3, 0x8d, 0x42, 0x4d, 0x6a, 0x51, 0xa8, 0x84, 0xf4, 0x21, 0x89, 0x6d,
+  0x18, 0xe9, 0xb5, 0x6d, 0x3f, 0x08, 0x58, 0x2a, 0xcd, 0x71, 0x30, 0xb4, 0x02, 0x4d, 0x9d, 0xaf,
+  0x30, 0x23, 0x62, 0xf6, 0x9f, 0x1b, 0xa5, 0x24, 0x05, 0x6e, 0x8a, 0x79, 0x8d, 0x95, 0x8b, 0xa7,
+  0xc2, 0x9f, 0x56, 0x82, 0xb6, 0x27, 0xab, 0x33, 0x1e, 0x85, 0xcd, 0x3c, 0x08, 0xbb, 0xb1, 0xd2,
+  0x5a, 0xd8, 0x6f, 0x97, 0x3f, 0xbe, 0x63, 0x01, 0x28, 0xdc, 0xa4, 0x73, 0xff, 0x58, 0xa8, 0xca,
+  0x30, 0x1e, 0x75, 0x69, 0x5e, 0x09, 0x5f, 0x94, 0x51, 0xd8, 0x14, 0x99, 0x98, 0x73, 0x87, 0x54,
+  0x5f, 0x0a, 0x1d, 0x6d, 0xb0, 0x91, 0x25, 0xa0, 0x15, 0x7e, 0x6e, 0x35, 0xd8, 0xf8, 0x8f, 0x33,
+  0x3a, 0xea, 0xe2, 0xbc, 0x5a, 0xe3, 0xa8, 0xe6, 0x74, 0x7c, 0x14, 0x6f, 0x5a, 0x65, 0xc6, 0x7c,
+  0xb9, 0x1d, 0x80, 0xd2, 0x20, 0x7b, 0x8f, 0xc6, 0x9f, 0xf0, 0xa5, 0xe1, 0x58, 0xf5, 0x8b, 0xf3,
+  0x5f, 0x97, 0xe1, 0x46, 0xed, 0xcd, 0x51, 0xdb, 0x4c, 0x26, 0x1d, 0xfc, 0x43, 0x9d, 0xe1, 0x0f,
+  0xc8, 0x2e, 0x58, 0x15, 0x91, 0xad, 0x07, 0x07, 0x83, 0xc1, 0x00, 0x1d, 0x38, 0x55, 0xd7, 0x6d,
+  0x82, 0x3d, 0xda, 0xce, 0xd3, 0xa4, 0xfd, 0xed, 0xfd, 0x03, 0x77, 0x7e, 0xb2, 0x92, 0x07, 0x07,
+  0x00, 0x00,
+};
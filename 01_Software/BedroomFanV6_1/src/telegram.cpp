@@ -9,6 +9,19 @@
 #include "myCredentials.h"
 #include "eventlog.h"
 #include "wifi_connect.h"
+#include "metrics.h"
+#include "timesync.h"
+#include "boot.h"
+#include "settings.h"
+#include "power.h"
+#include "scheduler.h"
+#include "perf.h"
+#include "trace.h"
+#include "updatelog.h"
+#include "bench.h"
+#include "hal.h"
+#include "localclock.h"
+#include "commandbus.h"
 
 using namespace std;
 
@@ -43,18 +56,18 @@ using namespace std;
 
 
 // ======== CONSTANTS ================
-const char EMOTICON_WELCOME[]   = { 0xf0, 0x9f, 0x99, 0x8b, 0xe2, 0x80, 0x8d, 0xe2, 0x99, 0x80, 0xef, 0xb8, 0x8f, 0x00 };
-const char EMOTICON_STOP[]      = { 0xf0, 0x9f, 0x9b, 0x91, 0x00 };
-const char EMOTICON_WIND[]      = { 0xf0, 0x9f, 0x92, 0xa8, 0x00 };
-const char EMOTICON_HOURGLASS[] = { 0xe2, 0x8f, 0xb3, 0x00 };
-const char EMOTICON_FINISH[]    = { 0xf0, 0x9f, 0x8f, 0x81, 0x00 };
-const char EMOTICON_EVENTLOG[]  = { 0xf0, 0x9f, 0x93, 0x9d, 0x00 };
-const char EMOTICON_CLEAR[]     = { 0xf0, 0x9f, 0x97, 0x91, 0x00 };     // Garbage bin
-const char EMOTICON_SETTINGS[]  = { 0xe2, 0x9a, 0x99, 0xef, 0xb8, 0x8f, 0x00 };
-const char EMOTICON_STATUS[]    = { 0xf0, 0x9f, 0xa9, 0xba, 0x00 };     // Stethoscope
-const char EMOTICON_MAIN[]      = { 0xf0, 0x9f, 0x94, 0x99, 0x00 };     // Back arrow
-const char EMOTICON_CLOCK[]     = { 0xf0, 0x9f, 0x95, 0x90, 0x00 };     // Clock
-const char EMOTICON_VERSION[]   = { 0xf0, 0x9f, 0xa7, 0xa0, 0x00 };  // 🧠
+const char EMOTICON_WELCOME[]   = "\xf0\x9f\x99\x8b\xe2\x80\x8d\xe2\x99\x80\xef\xb8\x8f";
+const char EMOTICON_STOP[]      = "\xf0\x9f\x9b\x91";
+const char EMOTICON_WIND[]      = "\xf0\x9f\x92\xa8";
+const char EMOTICON_HOURGLASS[] = "\xe2\x8f\xb3";
+const char EMOTICON_FINISH[]    = "\xf0\x9f\x8f\x81";
+const char EMOTICON_EVENTLOG[]  = "\xf0\x9f\x93\x9d";
+const char EMOTICON_CLEAR[]     = "\xf0\x9f\x97\x91";     // Garbage bin
+const char EMOTICON_SETTINGS[]  = "\xe2\x9a\x99\xef\xb8\x8f";
+const char EMOTICON_STATUS[]    = "\xf0\x9f\xa9\xba";     // Stethoscope
+const char EMOTICON_MAIN[]      = "\xf0\x9f\x94\x99";     // Back arrow
+const char EMOTICON_CLOCK[]     = "\xf0\x9f\x95\x90";     // Clock
+const char EMOTICON_VERSION[]   = "\xf0\x9f\xa7\xa0";  // 🧠
 
 // ======== TYPES ================
 enum keyboard_t { kbMain, kbSettings, kbClock };
@@ -70,6 +83,22 @@ keyboard_t currentKeyboard = kbMain;
 
 static std::map<int64_t, int32_t> lastMessageId;
 
+static uint32_t maxPollLatency = 0; // Slowest getNewMessage() in ms since last sample
+
+// Latency histograms of the calls to the Bot API
+static perf_t perfPoll  = NO_PERF;
+static perf_t perfSend  = NO_PERF;
+static perf_t perfEdit  = NO_PERF;
+static perf_t perfQuery = NO_PERF;
+
+struct CallCount {
+  uint32_t requests;
+  uint32_t errors;
+};
+
+static CallCount calls[TC_COUNT];
+static const char *CALL_NAMES[TC_COUNT] = { "poll", "send", "edit", "query" };
+
 // Map keyboard enum -> object
 std::map<keyboard_t, CTBotInlineKeyboard*> KEYBOARDS = {
   { kbMain,     &mainKeyboard     },
@@ -78,14 +107,15 @@ std::map<keyboard_t, CTBotInlineKeyboard*> KEYBOARDS = {
 };
 
 // ======== HELPERS =================
+// Bytes of input as a string literal, like the EMOTICON constants
 static String convertToHexString(String input) {
-  String result = "{ ";
+  String result = "\"";
   for (int i = 0; i < input.length(); i++) {
-    result += String("0x") + String((int)input[i], HEX) + ", ";
+    char hex[5];
+    snprintf(hex, sizeof(hex), "\\x%02x", (uint8_t)input[i]);
+    result += hex;
   }
-  result += "0x00 };";
-  result.toLowerCase();
-  // Serial.println(input + ": " + result);
+  result += "\";";
   return result;
 }
 
@@ -96,19 +126,52 @@ static int64_t getChatId(const TBMessage& msg) {
   return msg.sender.id;     // private chat
 }
 
+// Counts a call to the Bot API, a result of 0 or false is a failure
+template <typename T> static T counted(telegramCall_t call, T result) {
+  calls[call].requests++;
+  if (!result) calls[call].errors++;
+  return result;
+}
+
+// Timed and counted calls to the Bot API
+static int32_t sendMessage(int64_t chatId, const String& text) {
+  PerfTimer timer(perfSend);
+  return counted(tcSend, myBot.sendMessage(chatId, text));
+}
+
+static int32_t sendMessage(int64_t chatId, const String& text, CTBotInlineKeyboard& kbd) {
+  PerfTimer timer(perfSend);
+  return counted(tcSend, myBot.sendMessage(chatId, text, kbd));
+}
+
+static bool editMessage(int64_t chatId, int32_t msgId, const String& text) {
+  PerfTimer timer(perfEdit);
+  return counted(tcEdit, myBot.editMessageText(chatId, msgId, text));
+}
+
+static bool editMessage(int64_t chatId, int32_t msgId, const String& text, CTBotInlineKeyboard& kbd) {
+  PerfTimer timer(perfEdit);
+  return counted(tcEdit, myBot.editMessageText(chatId, msgId, text, kbd));
+}
+
+static bool endQuery(const String& queryId, const String& text) {
+  PerfTimer timer(perfQuery);
+  return counted(tcQuery, myBot.endQuery(queryId, text));
+}
+
 static void sendOrEdit(int64_t chatId, const String& text, CTBotInlineKeyboard* kbd = nullptr) {
   int32_t& msgId = lastMessageId[chatId];
 
   if (msgId > 0) {
-    if (kbd) myBot.editMessageText(chatId, msgId, text, *kbd);
-    else     myBot.editMessageText(chatId, msgId, text);
+    if (kbd) editMessage(chatId, msgId, text, *kbd);
+    else     editMessage(chatId, msgId, text);
   } else {
-    if (kbd) msgId = myBot.sendMessage(chatId, text, *kbd);
-    else     msgId = myBot.sendMessage(chatId, text);
+    if (kbd) msgId = sendMessage(chatId, text, *kbd);
+    else     msgId = sendMessage(chatId, text);
   }
 }
 
-static void sendLongMessage(uint32_t chatId, const String &text, CTBotInlineKeyboard *kbd = nullptr) {
+static void sendLongMessage(int64_t chatId, const String &text, CTBotInlineKeyboard *kbd = nullptr) {
   // Telegram text message max is 4096 chars.
   const size_t MAXLEN = 4096;
   size_t start = 0;
@@ -117,8 +180,8 @@ static void sendLongMessage(uint32_t chatId, const String &text, CTBotInlineKeyb
     size_t chunkLen = min(MAXLEN, text.length() - start);
     String chunk = text.substring(start, start + chunkLen);
 
-    if (kbd && start == 0) myBot.sendMessage(chatId, chunk, *kbd);
-    else                  myBot.sendMessage(chatId, chunk);
+    if (kbd && start == 0) sendMessage(chatId, chunk, *kbd);
+    else                  sendMessage(chatId, chunk);
 
     start += chunkLen;
   }
@@ -126,7 +189,7 @@ static void sendLongMessage(uint32_t chatId, const String &text, CTBotInlineKeyb
 
 static void sendMessageToKeyUser(String msg) {
   // keep same behavior: always attach the main keyboard
-  myBot.sendMessage(userid, msg, mainKeyboard);
+  sendMessage(userid, msg, mainKeyboard);
 }
 
 // ======== KEYBOARD BUILDERS =======
@@ -251,138 +314,142 @@ static String StatusMessage() {
       result = String(EMOTICON_HOURGLASS) + item;
       break;
     case fsClock:
-      result =  String(EMOTICON_CLOCK) + " Fan is switched on between "  + clock_on.to_String() +
-        String(" and ") + clock_off.to_String() + String(". It is currently ") + (fanIsOn() ? "on." : "off.");
+      result =  String(EMOTICON_CLOCK) + " Fan is switched on between "  + clock_on.text() +
+        " and " + clock_off.text() + ". It is currently " + (fanIsOn() ? "on." : "off.");
       break;
   }
 
   return result;
 }
 
-static String clockStatus() {
-  String result;
-  result  = String("Fan on from ")  + clock_on.to_String() + " until " + clock_off.to_String();
-  return result;
+// ======== CALLBACK / COMMAND HANDLING =======
+// Buttons that post a command to the bus, and the menu they leave open
+struct ButtonCommand {
+  const char *callbackData;
+  command_t   command;
+  int32_t     argument;
+  keyboard_t  keyboard;
+};
+
+static const ButtonCommand BUTTON_COMMANDS[] = {
+  { CB_FAN_ON,      cmFanOn,          0,          kbMain     },
+  { CB_FAN_OFF,     cmFanOff,         0,          kbMain     },
+  { CB_FAN_CLOCK,   cmFanClock,       0,          kbMain     },
+  { CB_TMR_20MIN,   cmFanTimer,       tdTimer20,  kbMain     },
+  { CB_TMR_1HR,     cmFanTimer,       tdTimer60,  kbMain     },
+  { CB_TMR_4HRS,    cmFanTimer,       tdTimer240, kbMain     },
+  { CB_STATUS,      cmInfo,           0,          kbMain     },
+  { CB_EVENTLOG,    cmEventLog,       0,          kbSettings },
+  { CB_EVENTCLR,    cmEventLogClear,  0,          kbSettings },
+  { CB_CLK_ON_MHR,  cmClockOnShift,  -60,         kbClock    },
+  { CB_CLK_ON_PHR,  cmClockOnShift,   60,         kbClock    },
+  { CB_CLK_ON_M15,  cmClockOnShift,  -15,         kbClock    },
+  { CB_CLK_ON_P15,  cmClockOnShift,   15,         kbClock    },
+  { CB_CLK_OFF_MHR, cmClockOffShift, -60,         kbClock    },
+  { CB_CLK_OFF_PHR, cmClockOffShift,  60,         kbClock    },
+  { CB_CLK_OFF_M15, cmClockOffShift, -15,         kbClock    },
+  { CB_CLK_OFF_P15, cmClockOffShift,  15,         kbClock    },
+};
+
+// Result of the command this front end ran last
+static String commandResult;
+
+static void keepResult(const Command &, const String &result) {
+  commandResult = result;
 }
 
-// ======== CALLBACK / COMMAND HANDLING =======
-static void handleCallback(const TBMessage &msg) {
-  String newMessage;
-  String userName = msg.sender.firstName + " " + msg.sender.lastName;
+// Post a command from the owner and run it before the reply is sent
+static String runCommand(const TBMessage &msg, command_t type, int32_t argument = 0) {
+  Command command;
+  command.type     = type;
+  command.argument = argument;
+  command.origin   = coTelegram;
+  command.user     = msg.sender.firstName + " " + msg.sender.lastName;
+  command.replyTo  = getChatId(msg);
+  command.reply    = keepResult;
+
+  commandResult = "Busy, try again";
+  if (postCommand(command)) runCommands();
+  return commandResult;
+}
+
+// "/health" for all metrics or "/health <metric>" for one, anything else is not ours
+static bool healthCommand(const String &text, int32_t &argument) {
+  metric_t metric;
+  argument = -1;
+  if (text == "/health") return true;
+  if (!text.startsWith("/health ") || !metricFromName(text.substring(8), metric)) return false;
+  argument = metric;
+  return true;
+}
 
+// Everything a button press does except the Bot API calls, returns the reply
+static String callbackAction(const TBMessage &msg) {
+  String newMessage;
   const String &cb = msg.callbackQueryData;
-  uint8_t time_changed = 0;
 
-  newMessage = "";
   struct tm timeinfo;
-  if (getLocalTime(&timeinfo)) {
-    char buf[32];
-    strftime(buf, sizeof(buf), "%H:%M ", &timeinfo);
-    newMessage = String(buf);
+  if (localClockTime(&timeinfo)) {
+    newMessage = formatClock(timeinfo.tm_hour * 60 + timeinfo.tm_min).c_str();
+    newMessage += ' ';
   }
 
-  // MAIN actions
-  if (cb == CB_FAN_ON) {
-    setFanModeOn();
-    addToEventLog(String("Fan switched on by ") + userName);
-    switchOnFan();
-    currentKeyboard = kbMain;
-  }
-  else if (cb == CB_FAN_OFF) {
-    setFanModeOff();
-    addToEventLog(String("Fan switched off by ") + userName);
-    switchOffFan();
-    currentKeyboard = kbMain;
+  const ButtonCommand *button = nullptr;
+  for (const ButtonCommand &b : BUTTON_COMMANDS) {
+    if (cb == b.callbackData) button = &b;
   }
-  else if (cb == CB_FAN_CLOCK) {
-    addToEventLog(String("Fan switched to clock mode by ") + userName);
-    setFanModeClock();
-    currentKeyboard = kbMain;
-  }
-  else if (cb == CB_TMR_20MIN) {
-    addToEventLog(String("Fan switched on for 20 minutes by ") + userName);
-    setFanModeTimer(tdTimer20);
-    currentKeyboard = kbMain;
-  }
-  else if (cb == CB_TMR_1HR) {
-    addToEventLog(String("Fan switched on for 1 hour by ") + userName);
-    setFanModeTimer(tdTimer60);
-    currentKeyboard = kbMain;
-  }
-  else if (cb == CB_TMR_4HRS) {
-    addToEventLog(String("Fan switched on for 4 hours by ") + userName);
-    setFanModeTimer(tdTimer240);
-    currentKeyboard = kbMain;
+
+  if (button) {
+    String result = runCommand(msg, button->command, button->argument);
+    currentKeyboard = button->keyboard;
+
+    switch (button->command) {
+      case cmInfo:
+        newMessage += String(EMOTICON_VERSION) + " " + result;
+        break;
+      case cmEventLog:
+        newMessage += String(EMOTICON_EVENTLOG) + " Event log:\n" + result;
+        break;
+      case cmEventLogClear:
+        newMessage += String(EMOTICON_EVENTLOG) + " " + result;
+        break;
+      case cmClockOnShift:
+      case cmClockOffShift:
+        newMessage += String(EMOTICON_CLOCK) + " " + result;
+        return newMessage; // The clock window instead of the status
+      default:
+        break; // The status below shows what the relay commands did
+    }
   }
+
+  // Menu navigation stays with this front end
   else if (cb == CB_SETTINGS) {
     newMessage += String(EMOTICON_SETTINGS) + " Settings menu\n";
     currentKeyboard = kbSettings;
   }
-  else if (cb == CB_STATUS) {
-    newMessage += String(EMOTICON_VERSION) + " Software version: " + bf_version + "\n";
-    newMessage += wifiConnectedTo() + "\n";
-    currentKeyboard = kbMain;
-  }
-
-  // SETTINGS actions
   else if (cb == CB_SET_CLOCK) {
     currentKeyboard = kbClock;
   }
-  else if (cb == CB_EVENTLOG) {
-    newMessage += String(EMOTICON_EVENTLOG) + " Event log:\n";
-    addToEventLog(String("Event log requested by ") + userName);
-    newMessage += getEventLogAsString();
-    currentKeyboard = kbSettings;
-  }
-  else if (cb == CB_EVENTCLR) {
-    newMessage += String(EMOTICON_EVENTLOG) + " Event log cleared\n";
-    clearEventLog();
-    addToEventLog(String("Event log cleared by ") + userName);
-    currentKeyboard = kbSettings;
-  }
   else if (cb == CB_MAIN) {
     currentKeyboard = kbMain;
   }
-
-  // Clock edit actions
-  else if (cb == CB_CLK_ON_MHR)  { clock_on. add_minutes(-60); time_changed=1; }
-  else if (cb == CB_CLK_ON_PHR)  { clock_on. add_minutes( 60); time_changed=1; }
-  else if (cb == CB_CLK_ON_M15)  { clock_on. add_minutes(-15); time_changed=1; }
-  else if (cb == CB_CLK_ON_P15)  { clock_on. add_minutes( 15); time_changed=1; }
-  else if (cb == CB_CLK_OFF_MHR) { clock_off.add_minutes(-60); time_changed=2; }
-  else if (cb == CB_CLK_OFF_PHR) { clock_off.add_minutes( 60); time_changed=2; }
-  else if (cb == CB_CLK_OFF_M15) { clock_off.add_minutes(-15); time_changed=2; }
-  else if (cb == CB_CLK_OFF_P15) { clock_off.add_minutes( 15); time_changed=2; }
-
   else {
     newMessage = "Command not recognized";
   }
-  // end of callback recognition
-
 
-  // Common actions if the time was changed
-  if(time_changed>0) {
+  newMessage += StatusMessage();
+  return newMessage;
+}
 
-    addToEventLog(String("Clock time changed by ") + userName);
-    currentKeyboard = kbClock;
+static void handleCallback(const TBMessage &msg) {
+  const String &cb = msg.callbackQueryData;
 
-    if(time_changed==1) {
-      if (clock_on.minutes_after_midnight >= clock_off.minutes_after_midnight) {
-        clock_on.minutes_after_midnight = clock_off.minutes_after_midnight-15;
-      }
-    } else if(time_changed==2) {
-      if (clock_off.minutes_after_midnight <= clock_on.minutes_after_midnight) {
-        clock_off.minutes_after_midnight = clock_on.minutes_after_midnight+15;
-      }
-    }
-    newMessage += String(EMOTICON_CLOCK) + " " + clockStatus();
-  }
-  else {
-    newMessage += StatusMessage();
-  }
+  traceStamp(trHandler);
+  String newMessage = callbackAction(msg);
 
   // Answer the callback query (Telegram UI spinner)
-  myBot.endQuery(msg.callbackQueryID, "OK");
+  endQuery(msg.callbackQueryID, "OK");
+  traceStamp(trAnswered);
 
   // Send response with current keyboard
   CTBotInlineKeyboard *kbd = KEYBOARDS[currentKeyboard];
@@ -393,6 +460,30 @@ static void handleCallback(const TBMessage &msg) {
   } else {
     sendOrEdit(getChatId(msg), newMessage, kbd);
   }
+  traceStamp(trReplied);
+}
+
+// ======== BENCHMARKS =======
+void benchStatusMessage() {
+  benchSink = StatusMessage().length();
+}
+
+// Buttons that only change the menu, nothing is switched or stored
+void benchCallbackDispatch() {
+  static const char *BUTTONS[] = { CB_SETTINGS, CB_SET_CLOCK, CB_MAIN, CB_STATUS };
+  static TBMessage msg;
+  static uint8_t next = 0;
+
+  msg.callbackQueryData = BUTTONS[next];
+  next = (next + 1) % 4;
+
+  keyboard_t keyboard = currentKeyboard;
+  benchSink = callbackAction(msg).length();
+  currentKeyboard = keyboard;
+}
+
+void benchBuildKeyboards() {
+  buildAllKeyboards();
 }
 
 // ======== PUBLIC API =======
@@ -404,19 +495,70 @@ void setupTelegram() {
 
   buildAllKeyboards();
   currentKeyboard = kbMain;
+  bootStageDone(bsTelegram);
+
+  perfPoll  = perfSection("tg poll");
+  perfSend  = perfSection("tg send");
+  perfEdit  = perfSection("tg edit");
+  perfQuery = perfSection("tg query");
 
+  addPeriodicJob("telegram", loopTelegram, 500, jpControl, 3000);
+}
+
+static void sendWelcome() {
   // Send welcome message to the owner
-  TBMessage msg;
   String text = String(EMOTICON_WELCOME) + " Welcome!\n";
   text += wifiConnectedTo() + "\n";
-  text += StatusMessage();
-  lastMessageId[userid] = myBot.sendMessage(userid, text, *KEYBOARDS[currentKeyboard]);
+  text += StatusMessage() + "\n";
+  text += String("Boot: ") + bootReport();
+  lastMessageId[userid] = sendMessage(userid, text, *KEYBOARDS[currentKeyboard]);
+  bootStageDone(bsWelcome);
+}
+
+uint32_t takeMaxPollLatency() {
+  uint32_t result = maxPollLatency;
+  maxPollLatency = 0;
+  return result;
+}
+
+uint32_t telegramRequests(telegramCall_t call) {
+  return calls[call].requests;
+}
+
+uint32_t telegramErrors(telegramCall_t call) {
+  return calls[call].errors;
+}
+
+const char *telegramCallName(telegramCall_t call) {
+  return CALL_NAMES[call];
 }
 
 void loopTelegram() {
   TBMessage msg;
 
-  if (myBot.getNewMessage(msg)) {
+  // Do not wait for a TLS connection that cannot succeed
+  if (!wifiIsConnected()) return;
+
+  // Full CPU speed for TLS, the rest of the time the CPU may slow down or sleep
+  PowerLock lock(plTelegram);
+
+  if (!bootStageIsDone(bsWelcome) && bootStageReady(bsWelcome)) sendWelcome();
+
+  uint32_t pollStart = halMillis();
+  int64_t pollStartUs = halMicros();
+  CTBotMessageType received;
+  {
+    PerfTimer timer(perfPoll);
+    received = myBot.getNewMessage(msg);
+  }
+  calls[tcPoll].requests++; // An empty poll and a failed one look the same
+  maxPollLatency = max(maxPollLatency, (uint32_t)(halMillis() - pollStart));
+
+  bool firstPoll = !bootStageIsDone(bsFirstPoll);
+  bootStageDone(bsFirstPoll);
+
+  if (received) {
+    recordUpdate(msg);
 
     // security: ignore messages not from your configured user
     if ((int64_t)msg.sender.id != userid) {
@@ -424,34 +566,84 @@ void loopTelegram() {
       return;
     }
 
+    bool query = msg.messageType == CTBotMessageQuery;
+    traceBegin(pollStartUs, query ? -1 : (int64_t)msg.date, query ? msg.callbackQueryData : msg.text);
+
     if (msg.messageType == CTBotMessageText) {
+      // The date of a fresh message is a rough clock source, the backlog from
+      // before boot is skipped. Callback queries carry the date of the old message.
+      if (!firstPoll) offerTime(tsTelegramUpdate, msg.date, 2000);
+
+      traceStamp(trHandler);
       String tgReply = msg.text;
+      int32_t healthArgument;
       Serial.print("Text message received: ");
       Serial.println(tgReply);
 
       if (tgReply == "/start") {
         String text = String(EMOTICON_WELCOME) + " Welcome!\n" + StatusMessage();
         currentKeyboard = kbMain;
-        myBot.sendMessage(getChatId(msg), text, *KEYBOARDS[currentKeyboard]);
+        sendMessage(getChatId(msg), text, *KEYBOARDS[currentKeyboard]);
       }
       else if (tgReply == "/status") {
         currentKeyboard = kbMain;
-        myBot.sendMessage(getChatId(msg), StatusMessage(), *KEYBOARDS[currentKeyboard]);
+        sendMessage(getChatId(msg), StatusMessage(), *KEYBOARDS[currentKeyboard]);
+      }
+      else if (healthCommand(tgReply, healthArgument)) {
+        String text = runCommand(msg, cmHealth, healthArgument);
+        currentKeyboard = kbMain;
+        sendMessage(getChatId(msg), String(EMOTICON_STATUS) + " " + text, *KEYBOARDS[currentKeyboard]);
+      }
+      else if (tgReply == "/jobs") {
+        currentKeyboard = kbMain;
+        sendMessage(getChatId(msg), runCommand(msg, cmJobs), *KEYBOARDS[currentKeyboard]);
+      }
+      else if (tgReply == "/power") {
+        currentKeyboard = kbMain;
+        sendMessage(getChatId(msg), runCommand(msg, cmPower), *KEYBOARDS[currentKeyboard]);
+      }
+      else if (tgReply == "/perf") {
+        currentKeyboard = kbMain;
+        sendMessage(getChatId(msg), runCommand(msg, cmPerf), *KEYBOARDS[currentKeyboard]);
+      }
+      else if (tgReply == "/trace json") {
+        currentKeyboard = kbMain;
+        sendLongMessage(getChatId(msg), traceChromeJson(), KEYBOARDS[currentKeyboard]);
+      }
+      else if (tgReply == "/trace") {
+        currentKeyboard = kbMain;
+        sendMessage(getChatId(msg), traceSummary(), *KEYBOARDS[currentKeyboard]);
+      }
+      else if (tgReply == "/bench") {
+        currentKeyboard = kbMain;
+        sendMessage(getChatId(msg), runBenchmarks(), *KEYBOARDS[currentKeyboard]);
+      }
+      else if (tgReply == "/updates clear") {
+        clearUpdateLog();
+        currentKeyboard = kbMain;
+        sendMessage(getChatId(msg), "Update log cleared", *KEYBOARDS[currentKeyboard]);
+      }
+      else if (tgReply == "/updates") {
+        currentKeyboard = kbMain;
+        sendLongMessage(getChatId(msg), updateLogReplay(), KEYBOARDS[currentKeyboard]);
       }
       else if (tgReply.startsWith("/hex ")) {
         String payload = tgReply.substring(5);
         String text = String("const char EMOTICON[] = ") + convertToHexString(payload);
         currentKeyboard = kbMain;
-        myBot.sendMessage(getChatId(msg), text, *KEYBOARDS[currentKeyboard]);
+        sendMessage(getChatId(msg), text, *KEYBOARDS[currentKeyboard]);
       }
       else {
         // echo + main keyboard
         currentKeyboard = kbMain;
-        myBot.sendMessage(getChatId(msg), String("Unknown command: ") + tgReply, *KEYBOARDS[currentKeyboard]);
+        sendMessage(getChatId(msg), String("Unknown command: ") + tgReply, *KEYBOARDS[currentKeyboard]);
       }
+      traceStamp(trReplied);
     }
     else if (msg.messageType == CTBotMessageQuery) {
       handleCallback(msg);
     }
+    bootStageDone(bsFirstCommand);
+    traceEnd();
   }
 }
@@ -2,6 +2,13 @@
 
 #include "version.h"
 
+// Calls to the Bot API
+enum telegramCall_t { tcPoll, tcSend, tcEdit, tcQuery, TC_COUNT };
+
 extern const String bf_version;
 void setupTelegram();
 void loopTelegram();
+uint32_t takeMaxPollLatency(); // Slowest poll in ms since the previous call
+uint32_t telegramRequests(telegramCall_t call); // Since boot
+uint32_t telegramErrors(telegramCall_t call);   // Failed calls since boot, polls never count
+const char *telegramCallName(telegramCall_t call);
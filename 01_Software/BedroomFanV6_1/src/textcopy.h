@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/*
+Copying text into a fixed char field.
+
+strlcpy cuts at a byte count, which can split a multi-byte UTF-8 character
+and leave an invalid sequence behind for JSON or a Telegram reply. This
+cuts before the character instead:
+
+  char label[16];
+  copyText(label, sizeof(label), text.c_str());
+*/
+
+// ======== FUNCTIONS ================
+// Copies text into out of size bytes, cut on a character boundary and
+// always terminated, returns the length copied
+inline size_t copyText(char *out, size_t size, const char *text) {
+  if (size == 0) return 0;
+  size_t length = strnlen(text, size - 1);
+  // A continuation byte right after the cut means a character is split
+  if (text[length] != '\0') {
+    while (length > 0 && ((uint8_t)text[length] & 0xc0) == 0x80) length--;
+  }
+  memcpy(out, text, length);
+  out[length] = '\0';
+  return length;
+}
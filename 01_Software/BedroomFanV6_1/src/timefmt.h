@@ -0,0 +1,119 @@
+#pragma once
+
+#include <stddef.h>
+#include <time.h>
+
+/*
+Time formatting and parsing without the heap.
+
+Formatting writes into a fixed buffer that is returned by value, parsing
+reads a plain C string. Nothing allocates and nothing needs iostream or
+the locale machinery of strftime, and every function can run in a
+constant expression:
+
+  constexpr ClockText t = formatClock(7 * 60 + 5);   // "07:05"
+  static_assert(t.text[1] == '7', "");
+
+A TimeText converts to const char *, so it appends to a String directly.
+*/
+
+// ======== TYPES ================
+template <size_t N>
+struct TimeText {
+  char text[N + 1] = {};
+
+  constexpr const char *c_str() const { return text; }
+  operator const char *() const { return text; }
+};
+
+typedef TimeText<5>  ClockText;      // "hh:mm", or "h:mm" without the padding of the hour
+typedef TimeText<19> TimestampText;  // "YYYY-MM-DD hh:mm:ss"
+
+// ======== HELPERS ================
+// Writes value with at least width digits, zero padded, returns the end
+constexpr char *putDigits(char *out, int value, int width) {
+  char digits[12] = {};
+  int count = 0;
+  unsigned int v = value < 0 ? 0 : value;
+  do {
+    digits[count++] = '0' + v % 10;
+    v /= 10;
+  } while (v > 0);
+  while (count < width) digits[count++] = '0';
+  while (count > 0) *out++ = digits[--count];
+  return out;
+}
+
+// Reads one or two digits, returns the position after them or nullptr
+constexpr const char *getDigits(const char *in, int &value) {
+  if (*in < '0' || *in > '9') return nullptr;
+  value = *in++ - '0';
+  if (*in >= '0' && *in <= '9') value = value * 10 + (*in++ - '0');
+  return in;
+}
+
+// ======== FUNCTIONS ================
+constexpr ClockText formatClock(int minutesAfterMidnight, bool padHour = true) {
+  ClockText result;
+  char *p = putDigits(result.text, minutesAfterMidnight / 60, padHour ? 2 : 1);
+  *p++ = ':';
+  putDigits(p, minutesAfterMidnight % 60, 2);
+  return result;
+}
+
+constexpr TimestampText formatTimestamp(const struct tm &t) {
+  TimestampText result;
+  char *p = putDigits(result.text, 1900 + t.tm_year, 4);
+  *p++ = '-';
+  p = putDigits(p, 1 + t.tm_mon, 2);
+  *p++ = '-';
+  p = putDigits(p, t.tm_mday, 2);
+  *p++ = ' ';
+  p = putDigits(p, t.tm_hour, 2);
+  *p++ = ':';
+  p = putDigits(p, t.tm_min, 2);
+  *p++ = ':';
+  putDigits(p, t.tm_sec, 2);
+  return result;
+}
+
+// "h:mm" or "hh:mm" after optional spaces, then the end or a non-digit; the rest is ignored.
+// false for a malformed or out of range time, minutesAfterMidnight is then unchanged.
+constexpr bool parseClock(const char *text, int &minutesAfterMidnight) {
+  while (*text == ' ' || *text == '\t') text++;
+
+  int hours = 0;
+  int minutes = 0;
+  text = getDigits(text, hours);
+  if (!text || *text++ != ':') return false;
+  text = getDigits(text, minutes);
+  if (!text || (*text >= '0' && *text <= '9') || hours > 23 || minutes > 59) return false;
+
+  minutesAfterMidnight = hours * 60 + minutes;
+  return true;
+}
+
+// ======== CHECKS ================
+namespace timefmt_checks {
+  constexpr bool equal(const char *a, const char *b) {
+    while (*a && *a == *b) { a++; b++; }
+    return *a == *b;
+  }
+  constexpr int parsed(const char *text) {
+    int minutes = -1;
+    return parseClock(text, minutes) ? minutes : -1;
+  }
+  constexpr struct tm newYear() {
+    struct tm t = {};
+    t.tm_year = 125; t.tm_mon = 0; t.tm_mday = 2; t.tm_hour = 3; t.tm_min = 4; t.tm_sec = 5;
+    return t;
+  }
+
+  static_assert(equal(formatClock(7 * 60 + 5).text, "07:05"), "");
+  static_assert(equal(formatClock(7 * 60 + 5, false).text, "7:05"), "");
+  static_assert(equal(formatClock(23 * 60 + 59).text, "23:59"), "");
+  static_assert(equal(formatTimestamp(newYear()).text, "2025-01-02 03:04:05"), "");
+  static_assert(parsed("8:05") == 8 * 60 + 5 && parsed(" 23:59") == 23 * 60 + 59, "");
+  static_assert(parsed("24:00") == -1 && parsed("7.30") == -1 && parsed(":30") == -1, "");
+  static_assert(parsed("7:123") == -1 && parsed("7:12 pm") == 7 * 60 + 12, "");
+}
@@ -1,11 +1,11 @@
 #pragma once
 
 #include <Arduino.h>
-#include "esp_system.h"
 #include "time.h"
 #include <list>
 #include <string>
-#include <WiFi.h>
+
+#include "hal.h"
 
 using namespace std;
 
@@ -20,26 +20,26 @@ const unsigned long MS_PER_WEEK =  7 * MS_PER_DAY;
 
 class milliSecTimer {
   public:
-    unsigned long previous;
-    unsigned long interval;
+    uint32_t previous; // 32 bit, so the arithmetic wraps with millis() on any host
+    uint32_t interval;
     bool autoReset; // Beware, reset happens only when calling lapsed(), and interval is not accurate
     
     // Constructor
-    milliSecTimer(unsigned long interval, bool autoReset = true) {
-      this->previous = millis();
+    milliSecTimer(uint32_t interval, bool autoReset = true) {
+      this->previous = halMillis();
       this->interval = interval;
       this->autoReset = autoReset;
     }
     
-    void reset() { previous = millis(); }
+    void reset() { previous = halMillis(); }
       
     bool lapsed() {
-      bool result = (millis() - previous >= interval );
+      bool result = (halMillis() - previous >= interval );
       if(result and autoReset) reset(); // interval could be made more accurate with % operator 
       return result;
     }
 
-    unsigned long remaining() {
-      return interval - (millis() - previous);
+    uint32_t remaining() {
+      return interval - (halMillis() - previous);
     }
 };
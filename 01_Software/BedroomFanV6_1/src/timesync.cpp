@@ -0,0 +1,306 @@
+#include "timesync.h"
+
+#include <esp_sntp.h>
+#include <esp_timer.h>
+#include <WiFi.h>
+#include <sys/time.h>
+#include <time.h>
+#include <math.h>
+
+#include "eventlog.h"
+#include "boot.h"
+#include "scheduler.h"
+#include "localclock.h"
+#include "timer.h"          // milliSecTimer
+#include "wifi_connect.h"
+#include "myCredentials.h"  // localTimezone
+
+// ======== CONSTANTS =================
+constexpr uint32_t SYNC_INTERVAL_MIN = 1 * MS_PER_HOUR;
+constexpr uint32_t SYNC_INTERVAL_MAX = 3 * MS_PER_DAY;
+constexpr int32_t  ERROR_BUDGET_US   = 250000;             // Allowed error between syncs
+constexpr uint32_t CORRECTION_PERIOD = 1 * MS_PER_MIN;     // How often the drift is corrected
+constexpr float    DRIFT_WEIGHT      = 0.3f;               // Weight of a new drift measurement
+constexpr float    DRIFT_LIMIT_PPM   = 500.0f;             // Larger values are measurement errors
+
+// Other time sources
+constexpr uint32_t DRIFT_BOUND_PPM     = 50;                  // Assumed worst case drift for uncertainty
+constexpr float    RESIDUAL_MIN_PPM    = 0.5f;                // Floor of the drift left after correction
+constexpr uint32_t NTP_UNCERTAINTY     = 50;                  // [ms]
+constexpr uint32_t HTTP_DATE_INTERVAL  = 5 * MS_PER_MIN;      // Retry period while NTP is unavailable
+constexpr uint32_t HTTP_DATE_TIMEOUT   = 2 * MS_PER_SEC;      // Connect and read together
+constexpr uint32_t DNS_TIMEOUT         = 4 * MS_PER_SEC;      // WiFi.hostByName() waits this long at most
+constexpr const char *HTTP_DATE_HOST   = "api.telegram.org";
+
+static const char *SOURCE_NAMES[] = { "none", "reset snapshot", "Telegram update", "HTTP date", "NTP" };
+
+// ======== STATE =====================
+struct TimeSyncState {
+  bool sntpStarted = false;
+  bool synced = false;
+  uint32_t syncs = 0;
+
+  // Written by the SNTP callback, handled in loopTimeSync()
+  volatile bool syncEvent = false;
+  int64_t eventMonoUs = 0;   // esp_timer at the sync
+  int64_t eventEpochUs = 0;  // NTP time at the sync
+
+  // Previous accepted sync
+  int64_t lastMonoUs = 0;
+  int64_t lastEpochUs = 0;
+
+  float   driftPpm = 0;         // Positive: local clock runs slow
+  bool    driftValid = false;
+  float   residualPpm = DRIFT_BOUND_PPM; // Drift left after the correction
+  int32_t offsetMs = 0;         // Error of the corrected clock at the last sync
+  uint32_t interval = SYNC_INTERVAL_MIN;
+
+  int64_t correctedMonoUs = 0;  // esp_timer when drift was last corrected
+  milliSecTimer correction { CORRECTION_PERIOD, true };
+
+  // Source that last set the clock
+  timeSource_t source = tsNone;
+  uint32_t sourceUncertainty = 0;  // [ms] when it was set
+  int64_t  sourceMonoUs = 0;       // esp_timer when it was set
+
+  milliSecTimer httpDate { HTTP_DATE_INTERVAL, true };
+  bool httpDateTried = false;
+};
+
+static TimeSyncState ts;
+
+// ======== HELPERS ===================
+static int64_t toMicros(const struct timeval *tv) {
+  return (int64_t)tv->tv_sec * 1000000 + tv->tv_usec;
+}
+
+// Called from the SNTP task
+static void onTimeSync(struct timeval *tv) {
+  ts.eventMonoUs  = esp_timer_get_time();
+  ts.eventEpochUs = toMicros(tv);
+  ts.syncEvent = true;
+}
+
+// Days since 1970-01-01 of a civil date (proleptic Gregorian calendar)
+static int32_t daysFromCivil(int y, unsigned m, unsigned d) {
+  y -= m <= 2;
+  const int era = (y >= 0 ? y : y - 399) / 400;
+  const unsigned yoe = (unsigned)(y - era * 400);
+  const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+  const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + (int32_t)doe - 719468;
+}
+
+// Parse an RFC 7231 date like "Sun, 06 Nov 1994 08:49:37 GMT"
+static bool parseHttpDate(const char *text, time_t &epoch) {
+  static const char MONTHS[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+  int day, year, hour, minute, second;
+  char month[4];
+
+  if (sscanf(text, "%*3s, %d %3s %d %d:%d:%d", &day, month, &year, &hour, &minute, &second) != 6) return false;
+
+  const char *found = strstr(MONTHS, month);
+  if (found == nullptr || (found - MONTHS) % 3 != 0) return false;
+  unsigned mon = (found - MONTHS) / 3 + 1;
+
+  epoch = (time_t)daysFromCivil(year, mon, day) * 86400 + hour * 3600 + minute * 60 + second;
+  return true;
+}
+
+// Read the Date header of a plain HTTP HEAD request. This is a short blocking
+// exchange, only done while NTP has not answered yet. The name lookup blocks
+// up to DNS_TIMEOUT, connect and read share HTTP_DATE_TIMEOUT.
+static void fetchHttpDate() {
+  IPAddress address;
+  if (!WiFi.hostByName(HTTP_DATE_HOST, address)) return;
+
+  WiFiClient client;
+  client.setTimeout((HTTP_DATE_TIMEOUT + 999) / 1000); // WiFiClient takes seconds
+
+  unsigned long start = millis();
+  if (!client.connect(address, 80, HTTP_DATE_TIMEOUT)) return;
+  client.print(String("HEAD / HTTP/1.1\r\nHost: ") + HTTP_DATE_HOST + "\r\nConnection: close\r\n\r\n");
+
+  char line[96];
+  size_t len = 0;
+  while (millis() - start < HTTP_DATE_TIMEOUT && (client.connected() || client.available())) {
+    int c = client.read();
+    if (c < 0) { delay(1); continue; }
+    if (c == '\r') continue;
+    if (c != '\n') {
+      if (len < sizeof(line) - 1) line[len++] = c;
+      continue;
+    }
+
+    line[len] = 0;
+    if (len == 0) break; // End of headers
+    len = 0;
+
+    time_t epoch;
+    if (strncasecmp(line, "Date: ", 6) == 0 && parseHttpDate(line + 6, epoch)) {
+      // One second resolution plus the round trip
+      offerTime(tsHttpDate, epoch, 1000 + (millis() - start));
+      break;
+    }
+  }
+  client.stop();
+}
+
+// Choose the next interval so the expected error stays within the budget
+static uint32_t adaptInterval(int64_t monoElapsedUs) {
+  if (!ts.driftValid) return SYNC_INTERVAL_MIN;
+
+  // Residual drift after correction, estimated from the error found at this sync
+  float residualPpm = fabsf(ts.offsetMs * 1000.0f) * 1e6f / monoElapsedUs;
+  ts.residualPpm = min(max(residualPpm, RESIDUAL_MIN_PPM), (float)DRIFT_BOUND_PPM);
+
+  float seconds = ERROR_BUDGET_US / ts.residualPpm;
+  uint32_t result = (uint32_t)min(seconds * 1000.0f, (float)SYNC_INTERVAL_MAX);
+  return max(result, SYNC_INTERVAL_MIN);
+}
+
+static void handleSync() {
+  ts.syncEvent = false;
+  int64_t mono  = ts.eventMonoUs;
+  int64_t epoch = ts.eventEpochUs;
+  int64_t monoElapsed = mono - ts.lastMonoUs;
+
+  if (ts.synced) {
+    int64_t epochElapsed = epoch - ts.lastEpochUs;
+
+    // Where the corrected clock expected to be, compared to NTP
+    int64_t predicted = ts.lastEpochUs + monoElapsed + (int64_t)(ts.driftPpm * monoElapsed / 1e6);
+    ts.offsetMs = (int32_t)((epoch - predicted) / 1000);
+
+    if (monoElapsed > 10 * 60 * 1000000LL) {
+      float measured = (float)(epochElapsed - monoElapsed) * 1e6f / monoElapsed;
+      if (fabsf(measured) < DRIFT_LIMIT_PPM) {
+        ts.driftPpm = ts.driftValid ? ts.driftPpm + DRIFT_WEIGHT * (measured - ts.driftPpm) : measured;
+        ts.driftValid = true;
+      }
+    }
+  }
+
+  ts.interval = ts.synced ? adaptInterval(monoElapsed) : SYNC_INTERVAL_MIN;
+  sntp_set_sync_interval(ts.interval);
+
+  ts.lastMonoUs = mono;
+  ts.lastEpochUs = epoch;
+  ts.correctedMonoUs = mono;
+  ts.syncs++;
+
+  ts.source = tsNtp;
+  ts.sourceUncertainty = NTP_UNCERTAINTY;
+  ts.sourceMonoUs = mono;
+  bootStageDone(bsTime);
+
+  if (!ts.synced) addToEventLog("Time synced via NTP");
+  else addToEventLogf("Time synced via NTP, offset %d ms, drift %.1f ppm, next sync in %u min",
+                      ts.offsetMs, ts.driftPpm, ts.interval / MS_PER_MIN);
+  ts.synced = true;
+}
+
+// Slew the system clock by the drift accumulated since the last correction
+static void correctDrift() {
+  if (!ts.driftValid) return;
+
+  int64_t now = esp_timer_get_time();
+  int64_t deltaUs = (int64_t)(ts.driftPpm * (now - ts.correctedMonoUs) / 1e6);
+  if (deltaUs == 0) return;
+
+  struct timeval delta = { (time_t)(deltaUs / 1000000), (suseconds_t)(deltaUs % 1000000) };
+  if (adjtime(&delta, nullptr) == 0) ts.correctedMonoUs = now;
+}
+
+// ======== PUBLIC API ================
+void setupTimeSync() {
+  // Local time must work before NTP is started, other sources may set the clock first
+  localClockSetZone(localTimezone);
+
+  sntp_set_time_sync_notification_cb(onTimeSync);
+  sntp_set_sync_mode(SNTP_SYNC_MODE_IMMED);
+  sntp_set_sync_interval(SYNC_INTERVAL_MIN);
+
+  // The HTTP Date fallback may block for the name lookup and its timeout
+  addPeriodicJob("time", loopTimeSync, 1 * MS_PER_SEC, jpNetwork, DNS_TIMEOUT + HTTP_DATE_TIMEOUT + 500);
+}
+
+void loopTimeSync() {
+  // SNTP keeps running in the background once started, also across reconnects
+  if (!ts.sntpStarted && wifiIsConnected()) {
+    Serial.println("Start NTP");
+    configTzTime(localTimezone,
+                 "time.google.com",
+                 "time.windows.com",
+                 "pool.ntp.org");
+    ts.sntpStarted = true;
+  }
+
+  if (ts.syncEvent) handleSync();
+  if (ts.correction.lapsed()) correctDrift();
+
+  // Fall back on the HTTP Date header until NTP has answered once
+  bool wantHttpDate = ts.source < tsHttpDate;
+  if (wantHttpDate && wifiIsConnected() && (!ts.httpDateTried || ts.httpDate.lapsed())) {
+    ts.httpDateTried = true;
+    ts.httpDate.reset();
+    fetchHttpDate();
+  }
+}
+
+bool offerTime(timeSource_t source, time_t epoch, uint32_t uncertaintyMs) {
+  // NTP sets the clock itself, and keeps it once it has answered: SNTP runs
+  // until the reset and is far more precise than any other source
+  if (source >= tsNtp || ts.source == tsNtp) return false;
+
+  bool better = source > ts.source || uncertaintyMs < timeUncertaintyMs();
+  if (!better) return false;
+
+  struct timeval tv = { epoch, 0 };
+  settimeofday(&tv, nullptr);
+  localClockTick();
+
+  bool first = ts.source == tsNone;
+  ts.source = source;
+  ts.sourceUncertainty = uncertaintyMs;
+  ts.sourceMonoUs = esp_timer_get_time();
+  bootStageDone(bsTime);
+
+  if (first) addToEventLogf("Clock set from %s, uncertainty %u ms", SOURCE_NAMES[source], uncertaintyMs);
+  return true;
+}
+
+timeSource_t timeSource() {
+  return ts.source;
+}
+
+uint32_t timeUncertaintyMs() {
+  if (ts.source == tsNone) return UINT32_MAX;
+  uint32_t elapsedMs = (esp_timer_get_time() - ts.sourceMonoUs) / 1000;
+
+  // Between NTP syncs only the drift the correction misses adds up
+  float ppm = ts.source == tsNtp && ts.driftValid ? ts.residualPpm : DRIFT_BOUND_PPM;
+  return ts.sourceUncertainty + (uint32_t)(elapsedMs * ppm / 1e6f);
+}
+
+bool timeIsSynced() {
+  return ts.synced;
+}
+
+int32_t ntpOffsetMs() {
+  return ts.offsetMs;
+}
+
+String timeSyncStatus() {
+  if (ts.source == tsNone) return "Clock not set";
+
+  char buf[128];
+  if (!ts.synced) {
+    snprintf(buf, sizeof(buf), "Clock set from %s, uncertainty %u ms, waiting for NTP",
+             SOURCE_NAMES[ts.source], timeUncertaintyMs());
+  } else {
+    snprintf(buf, sizeof(buf), "Clock synced %u times, last offset %d ms, drift %.1f ppm%s",
+             ts.syncs, ts.offsetMs, ts.driftPpm, ts.driftValid ? "" : " (estimating)");
+  }
+  return String(buf);
+}
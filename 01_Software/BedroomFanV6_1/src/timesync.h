@@ -0,0 +1,36 @@
+#pragma once
+
+#include <Arduino.h>
+#include <time.h>
+
+/*
+Clock synchronisation with NTP.
+
+SNTP runs in the background and reports each sync through a callback, so
+nothing blocks. The drift of the crystal is estimated from successive syncs
+and corrected with adjtime() in between. The sync interval grows as the
+estimate improves.
+
+Until NTP answers, less precise sources can set the clock, such as the HTTP
+Date header of api.telegram.org or the date of a Telegram update. A source
+is accepted when it ranks higher than the current one, or when it is more
+accurate than the current time has become since it was set. Once NTP has
+answered, no other source sets the clock again.
+*/
+
+// ======== TYPES ================
+// Time sources, in increasing order of quality
+enum timeSource_t { tsNone, tsRestored, tsTelegramUpdate, tsHttpDate, tsNtp };
+
+// ======== FUNCTIONS ================
+void setupTimeSync();
+void loopTimeSync();
+
+// Offer a time from a source other than NTP, returns true if the clock was set
+bool offerTime(timeSource_t source, time_t epoch, uint32_t uncertaintyMs);
+
+timeSource_t timeSource();    // Source that last set the clock
+uint32_t timeUncertaintyMs(); // Estimated error of the clock now
+bool timeIsSynced();     // True after the first NTP sync
+int32_t ntpOffsetMs();   // Error of the corrected clock found at the last sync
+String timeSyncStatus(); // Human readable summary for the status message
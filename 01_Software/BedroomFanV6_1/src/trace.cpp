@@ -0,0 +1,145 @@
+#include "trace.h"
+
+#include <esp_timer.h>
+#include <sys/time.h>
+
+#include "textcopy.h"
+
+// ======== CONSTANTS =================
+constexpr size_t TRACE_COUNT = 16;
+
+// Name of the span that ends at a stage, the relay is an instant
+static const char *SPAN_NAMES[TR_COUNT] = { "", "poll", "dispatch", "relay", "answer", "reply" };
+
+// ======== TYPES =====================
+struct Trace {
+  int64_t  updateDate;      // -1 if not known
+  int32_t  lagMs;           // Wall clock at receipt minus update date, -1 without a date or a clock
+  char     label[16];       // Callback data or command
+  uint8_t  stamped;         // Bit mask of stamped stages
+  int64_t  stamps[TR_COUNT];
+};
+
+// ======== STATE =====================
+static Trace traces[TRACE_COUNT];
+static size_t traceHead = 0;
+static size_t traceCount = 0;
+
+static Trace current;
+static bool active = false;
+
+// ======== HELPERS ===================
+static bool stamped(const Trace &t, int stage) {
+  return t.stamped & (1 << stage);
+}
+
+// Ring index of the n-th most recent trace
+static const Trace &recentTrace(size_t n) {
+  return traces[(traceHead + TRACE_COUNT - 1 - n) % TRACE_COUNT];
+}
+
+static int64_t lastStamp(const Trace &t) {
+  int64_t last = t.stamps[trPoll];
+  for (int stage = 0; stage < TR_COUNT; stage++) {
+    if (stamped(t, stage) && t.stamps[stage] > last) last = t.stamps[stage];
+  }
+  return last;
+}
+
+// ======== PUBLIC API ================
+void traceBegin(int64_t pollStartUs, int64_t updateDate, const String &label) {
+  memset(&current, 0, sizeof(current));
+  current.updateDate = updateDate;
+
+  // Shorten on a character boundary, a split UTF-8 sequence is not valid JSON
+  copyText(current.label, sizeof(current.label), label.c_str());
+
+  // The label ends up in JSON, keep it plain
+  for (char *c = current.label; *c; c++) {
+    if (*c == '"' || *c == '\\' || (uint8_t)*c < ' ') *c = '_';
+  }
+
+  current.stamps[trPoll] = pollStartUs;
+  current.stamped = 1 << trPoll;
+  active = true;
+  traceStamp(trReceived);
+
+  struct timeval tv;
+  gettimeofday(&tv, nullptr);
+  bool known = updateDate >= 0 && tv.tv_sec > 1600000000;
+  current.lagMs = known ? (int64_t)tv.tv_sec * 1000 + tv.tv_usec / 1000 - updateDate * 1000 : -1;
+}
+
+void traceStamp(traceStage_t stage) {
+  if (!active || stamped(current, stage)) return;
+  current.stamps[stage] = esp_timer_get_time();
+  current.stamped |= 1 << stage;
+}
+
+void traceEnd() {
+  if (!active) return;
+  active = false;
+
+  traces[traceHead] = current;
+  traceHead = (traceHead + 1) % TRACE_COUNT;
+  if (traceCount < TRACE_COUNT) traceCount++;
+}
+
+String traceSummary() {
+  if (traceCount == 0) return "No traces yet";
+
+  String result = "Update: ms after poll start per stage, lag from tap\n";
+  char line[48];
+
+  for (size_t i = 0; i < traceCount; i++) {
+    const Trace &t = recentTrace(i);
+    result += String(t.label) + ":";
+    for (int stage = trReceived; stage < TR_COUNT; stage++) {
+      if (!stamped(t, stage)) continue;
+      snprintf(line, sizeof(line), " %s %.0f", SPAN_NAMES[stage], (t.stamps[stage] - t.stamps[trPoll]) / 1000.0f);
+      result += line;
+    }
+    if (t.lagMs >= 0) result += String(", lag ") + String(t.lagMs) + " ms";
+    result += "\n";
+  }
+  return result;
+}
+
+String traceChromeJson() {
+  String result = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  char event[192];
+  bool first = true;
+
+  // Oldest first, so the timeline reads left to right
+  for (size_t i = traceCount; i-- > 0;) {
+    const Trace &t = recentTrace(i);
+
+    snprintf(event, sizeof(event),
+             "%s\n{\"name\":\"%s\",\"cat\":\"update\",\"ph\":\"X\",\"ts\":%lld,\"dur\":%lld,\"pid\":1,\"tid\":1,"
+             "\"args\":{\"date\":%lld,\"lag_ms\":%d}}",
+             first ? "" : ",", t.label, (long long)t.stamps[trPoll],
+             (long long)(lastStamp(t) - t.stamps[trPoll]), (long long)t.updateDate, t.lagMs);
+    result += event;
+    first = false;
+
+    int64_t spanStart = t.stamps[trPoll];
+    for (int stage = trReceived; stage < TR_COUNT; stage++) {
+      if (!stamped(t, stage)) continue;
+
+      if (stage == trRelay) {
+        snprintf(event, sizeof(event),
+                 ",\n{\"name\":\"relay\",\"cat\":\"stage\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%lld,\"pid\":1,\"tid\":1}",
+                 (long long)t.stamps[stage]);
+      } else {
+        snprintf(event, sizeof(event),
+                 ",\n{\"name\":\"%s\",\"cat\":\"stage\",\"ph\":\"X\",\"ts\":%lld,\"dur\":%lld,\"pid\":1,\"tid\":1}",
+                 SPAN_NAMES[stage], (long long)spanStart, (long long)(t.stamps[stage] - spanStart));
+        spanStart = t.stamps[stage];
+      }
+      result += event;
+    }
+  }
+
+  result += "\n]}";
+  return result;
+}
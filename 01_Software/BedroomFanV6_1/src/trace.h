@@ -0,0 +1,33 @@
+#pragma once
+
+#include <Arduino.h>
+
+/*
+Traces of Telegram requests, from the poll that received the update to the
+reply, with the moment the relay switched.
+
+Each handled update gets one trace, stamped with the date of the update and
+the esp_timer time of every stage it passed. The last traces are kept in a
+ring buffer and can be exported as Chrome trace JSON (chrome://tracing or
+ui.perfetto.dev) to see where the time between tap and click goes.
+*/
+
+// ======== TYPES ================
+enum traceStage_t {
+  trPoll,     // getNewMessage() called
+  trReceived, // Update received and parsed
+  trHandler,  // Command or callback handler started
+  trRelay,    // Relay switched
+  trAnswered, // Callback query answered, the spinner stops
+  trReplied,  // Reply sent or message edited
+  TR_COUNT
+};
+
+// ======== FUNCTIONS ================
+// updateDate is -1 for callback queries, which carry no date of their own
+void traceBegin(int64_t pollStartUs, int64_t updateDate, const String &label);
+void traceStamp(traceStage_t stage); // Only the first stamp of a stage counts, no-op without a trace
+void traceEnd();                     // Store the trace in the ring buffer
+
+String traceSummary();    // Latency per stage of the recent traces
+String traceChromeJson(); // Recent traces in the Chrome trace event format
@@ -0,0 +1,94 @@
+#include "updatelog.h"
+
+#include <rom/crc.h>
+
+#include "hal.h"
+#include "textcopy.h"
+
+// ======== CONSTANTS =================
+constexpr size_t   RECORD_COUNT = 16;
+constexpr uint32_t UPDATELOG_MAGIC = 0x55504431; // "UPD1", bump when the layout changes
+
+// ======== TYPES =====================
+struct UpdateRecord {
+  int64_t  chatId;
+  int64_t  senderId;
+  uint32_t receivedMs;  // millis() when received
+  uint32_t date;        // Date of the update, of the message for a callback query
+  uint8_t  type;        // CTBotMessageType
+  char     data[39];    // Text or callback data, cut off
+};
+
+// 16 records of 64 bytes, next to the metrics archive in RTC slow memory
+struct UpdateLog {
+  uint32_t magic;
+  uint16_t head;
+  uint16_t count;
+  UpdateRecord records[RECORD_COUNT];
+  uint32_t crc;
+};
+
+// ======== STATE =====================
+RTC_NOINIT_ATTR static UpdateLog updateLog;
+
+// ======== HELPERS ===================
+static uint32_t updateLogCrc() {
+  return crc32_le(0, (const uint8_t *)&updateLog, offsetof(UpdateLog, crc));
+}
+
+static String escape(const char *data) {
+  String result;
+  for (const char *c = data; *c; c++) {
+    if (*c == '\\')      result += "\\\\";
+    else if (*c == '\n') result += "\\n";
+    else                 result += *c;
+  }
+  return result;
+}
+
+// ======== PUBLIC API ================
+void setupUpdateLog() {
+  if (updateLog.magic != UPDATELOG_MAGIC || updateLog.crc != updateLogCrc()) {
+    clearUpdateLog();
+  } else {
+    Serial.printf("Update log restored: %u updates\n", updateLog.count);
+  }
+}
+
+void recordUpdate(const TBMessage &msg) {
+  if (msg.messageType != CTBotMessageText && msg.messageType != CTBotMessageQuery) return;
+
+  UpdateRecord &r = updateLog.records[updateLog.head];
+  r.chatId     = msg.group.id != 0 ? msg.group.id : msg.sender.id;
+  r.senderId   = msg.sender.id;
+  r.receivedMs = halMillis();
+  r.date       = msg.date;
+  r.type       = msg.messageType;
+  copyText(r.data, sizeof(r.data), (msg.messageType == CTBotMessageQuery ? msg.callbackQueryData : msg.text).c_str());
+
+  updateLog.head = (updateLog.head + 1) % RECORD_COUNT;
+  if (updateLog.count < RECORD_COUNT) updateLog.count++;
+  updateLog.crc = updateLogCrc();
+}
+
+String updateLogReplay() {
+  String result = String("# ") + updateLog.count + " updates, replay with: program --replay <file>\n";
+  result.reserve(updateLog.count * 64);
+
+  for (size_t n = updateLog.count; n > 0; n--) {
+    const UpdateRecord &r = updateLog.records[(updateLog.head + RECORD_COUNT - n) % RECORD_COUNT];
+    char line[64];
+    snprintf(line, sizeof(line), "%u %u %lld %lld %c ", r.receivedMs, r.date, (long long)r.chatId,
+             (long long)r.senderId, r.type == CTBotMessageQuery ? 'q' : 't');
+    result += line;
+    result += escape(r.data);
+    result += "\n";
+  }
+  return result;
+}
+
+void clearUpdateLog() {
+  memset(&updateLog, 0, sizeof(updateLog));
+  updateLog.magic = UPDATELOG_MAGIC;
+  updateLog.crc = updateLogCrc();
+}
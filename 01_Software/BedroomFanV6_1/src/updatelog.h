@@ -0,0 +1,30 @@
+#pragma once
+
+#include <Arduino.h>
+#include <CTBot.h>
+
+/*
+Recorder of the Telegram updates the bot received.
+
+Every update that comes out of getNewMessage() is recorded, before the
+sender check, so the updates of other group members are in it too. The
+last updates are kept in RTC slow memory with a CRC, like the metrics
+archive: they survive the crash or watchdog reset that usually follows
+something odd, but not a power cycle.
+
+CTBot hands out parsed updates only, so a record holds the fields the
+firmware uses. /updates sends the recording in the replay format, one
+update per line:
+
+  <millis> <date> <chat id> <sender id> <t|q> <text or callback data>
+
+t is a text message, q a callback query. Backslashes and newlines in the
+data are escaped as \\ and \n. The host build replays such a file through
+the firmware, see native/replay.h.
+*/
+
+// ======== FUNCTIONS ================
+void setupUpdateLog();                    // Keep the recording of before the reset, if it is valid
+void recordUpdate(const TBMessage &msg);  // Cheap, a copy into RTC memory
+String updateLogReplay();                 // Recorded updates in the replay format, oldest first
+void clearUpdateLog();
@@ -24,10 +24,35 @@ Version history
     Increased WiFi power to extend connection
     Implemented reconnect to other stations if signal is lost
     Repaired returning messages to group chats
+6.2 Health metrics (RSSI, heap, reconnects, poll latency, fan on-time) in a round robin store, /health command
+    Non-blocking WiFi reconnect with back-off, escalating to AP switch, radio restart and ESP restart
+    Fast boot connect using the cached access point, channel and IP address
+    Roaming to a stronger access point when the signal degrades
+    Non-blocking NTP sync with drift correction and adaptive sync interval
+    Clock set from the HTTP Date header or Telegram messages until NTP is available
+    Fan mode, timer, clock window and time restored from RTC memory after a reset
+    Boot in stages without blocking, with per-stage timing in the welcome and status messages
+    Settings stored in NVS, with writes postponed until the clock menu is left alone
+    Power management: modem sleep, frequency scaling and light sleep in SDK builds that enable them, /power model
+    Job scheduler instead of a fixed 500 ms loop, fan control driven by deadlines, /jobs command
+    Latency histograms of jobs and Bot API calls, stack high-water marks and heap statistics, /perf command
+    Tracing of Telegram requests from poll to relay to reply, /trace summary and Chrome trace export
+    Hardware abstraction layer and a native build that runs the firmware on Linux
+    Simulation of a year against a virtual clock, checking the relay through DST changes and millis() wraps
+    Fan follows an edit of the clock window at once instead of at the next minute
+    Benchmark of the Telegram layer against a Bot API stand-in with latency and fault injection
+    Event log sent in chunks to the right chat in supergroups (chat id was cut to 32 bits)
+    Recorder of received updates in RTC memory, /updates export and replay against a golden transcript on Linux
+    Microbenchmarks of the per-tap functions with allocation counts, /bench command
+    Time formatting and parsing without iostream or the heap (timefmt.h), constexpr and checked at compile time
+    Local time from a cached UTC offset and DST period (localclock.h), one "now" per scheduler job
+    Command bus with a priority queue shared by Telegram and a serial console command line
+    MQTT client with retained state, command topics and Home Assistant discovery, on Linux with --mqtt
+    HTTP server with REST endpoints, gzipped status page with ETag and mDNS bedroomfan.local, on Linux with --http
+    Prometheus /metrics with relay, Telegram, WiFi, NTP and heap counters and latency histograms
+    Event log sent to a syslog collector as RFC 5424 messages over UDP with sequence numbers, on Linux with --syslog
 
 To do:
- - store settings in NVS
- - do not act on !getLocalTime(&timeinfo)) every loop
  - maybe backup error log once in a while to SPIFFS
  - maybe also allow clock to switch over midnight
 */
@@ -2,57 +2,523 @@
 
 #include <esp_wifi.h>
 #include <WiFi.h>
-#include <WiFiMulti.h>
-#include <time.h>
+#include <Preferences.h>
+#include <rom/crc.h>
 
-#include "eventLog.h"
+#include "eventlog.h"
+#include "boot.h"
+#include "power.h"
+#include "scheduler.h"
 #include "timer.h"          // milliSecTimer
-#include "myCredentials.h"  // ACCESS_POINTS, localTimezone
+#include "myCredentials.h"  // ACCESS_POINTS
 
 // ======== CONSTANTS =================
-constexpr uint32_t CONNECT_TIMEOUT_BOOT = 10 * MS_PER_SEC;
-constexpr uint32_t CONNECT_TIMEOUT_LOOP = 500;
+constexpr uint32_t CONNECT_TIMEOUT = 10 * MS_PER_SEC;  // Single connect attempt
+constexpr uint32_t FAST_CONNECT_TIMEOUT = 3 * MS_PER_SEC; // Connect attempt using the cached access point
+constexpr uint32_t BACKOFF_MIN     =  1 * MS_PER_SEC;
+constexpr uint32_t BACKOFF_MAX     = 60 * MS_PER_SEC;
+constexpr uint32_t RADIO_OFF_TIME  =  1 * MS_PER_SEC;
+constexpr time_t   LEASE_REUSE_MAX = 10 * 60;          // [s] Shorter than any lease a home router hands out
+
+// Roaming
+constexpr uint32_t ROAM_SAMPLE_INTERVAL = 2 * MS_PER_SEC;  // RSSI sample period
+constexpr uint32_t ROAM_COOLDOWN        = 5 * MS_PER_MIN;  // Minimum time between roam scans
+constexpr int      ROAM_RSSI_THRESHOLD  = -72;             // Start looking below this average [dBm]
+constexpr int      ROAM_HYSTERESIS      = 8;               // Candidate must be this much better [dB]
+constexpr int      ROAM_AVERAGE_WEIGHT  = 8;               // Moving average over ~8 samples
+constexpr uint32_t ROAM_SCAN_TIME       = 120;             // Active scan time per channel [ms]
+
+// ======== TYPES =====================
+enum wifiState_t { wsConnecting, wsConnected, wsBackoff, wsScanning, wsRadioOff, wsRoamScanning, wsLeasing };
+
+// Recovery steps, each one is taken when the matching escalation timer lapses
+enum wifiEscalation_t { weReconnect, weSwitchAP, weRadioRestart, weRadioRestart2, weDeviceRestart };
+
+constexpr uint32_t WIFI_CACHE_MAGIC = 0x57434332; // "WCC2", bump when the layout changes
+
+// ======== TYPES =====================
+// Last successful connection, kept in RTC memory (soft reset) and NVS (power on)
+struct WifiCache {
+  uint32_t magic;
+  char     ssid[33];
+  uint8_t  bssid[6];
+  uint8_t  channel;
+  uint32_t ip;
+  uint32_t gateway;
+  uint32_t subnet;
+  uint32_t dns;
+  time_t   leaseStart;  // System time the address was last bound, only trusted after a soft reset
+  uint32_t crc;
+};
+
+// Best roaming candidate found so far
+struct RoamCandidate {
+  String  ssid;
+  uint8_t bssid[6];
+  uint8_t channel;
+  int     rssi;
+};
 
 // ======== STATE =====================
 struct WifiState {
-  bool wifiReportedConnected = true;
-  bool clockSynced = false;
-  uint8_t reconnectReported = 0;
+  wifiState_t state = wsScanning;
+  wifiEscalation_t escalation = weReconnect;
+  uint32_t reconnects = 0;
+  uint32_t backoffInterval = BACKOFF_MIN;
+
+  bool fastConnect = false;          // Current attempt uses the cached access point
+  bool cachedIP = false;             // Static configuration from the cache, DHCP is off
+  milliSecTimer leaseHandback { LEASE_REUSE_MAX * MS_PER_SEC, false }; // Back to DHCP before the cached lease may expire
+  unsigned long attemptStarted = 0;  // millis() when the current attempt started
+  uint32_t associationTime = 0;      // Duration of the last successful attempt in ms
+
+  // Escalation timers, all reset when the connection is lost
+  milliSecTimer reconnect1 { 1 * MS_PER_MIN, false }; // Scan and switch to the best access point
+  milliSecTimer reconnect2 { 2 * MS_PER_MIN, false }; // Restart the radio
+  milliSecTimer reconnect3 { 5 * MS_PER_MIN, false }; // Restart the radio once more
+  milliSecTimer restart    {10 * MS_PER_MIN, false }; // Restart the ESP
+
+  milliSecTimer backoff { BACKOFF_MIN,     false };
+  milliSecTimer attempt { CONNECT_TIMEOUT, false };
+  milliSecTimer radioOff{ RADIO_OFF_TIME,  false };
 
-  milliSecTimer reconnect1 { 1 * MS_PER_MIN, false };
-  milliSecTimer reconnect2 { 2 * MS_PER_MIN, false };
-  milliSecTimer reconnect3 { 5 * MS_PER_MIN, false };
-  milliSecTimer restart    {10 * MS_PER_MIN, false };
-  milliSecTimer syncClock  { 3 * MS_PER_DAY, true };
+  // Roaming
+  milliSecTimer roamSample   { ROAM_SAMPLE_INTERVAL, true };
+  milliSecTimer roamCooldown { ROAM_COOLDOWN, false };
+  int32_t  rssiAverage16 = 0;      // Moving average of RSSI, times 16
+  uint16_t knownChannels = 0;      // Bit n set: a configured SSID was seen on channel n
+  uint8_t  roamChannel = 0;        // Channel currently being scanned
+  RoamCandidate roamCandidate;
+  bool     roaming = false;        // Current attempt is a roam
+  unsigned long roamStarted = 0;
+  uint32_t roams = 0;
+  uint32_t lastRoamDowntime = 0;
 
-  WiFiMulti multi;
+  // Set from the WiFi event task, handled in loopWifi()
+  volatile bool eventGotIP = false;
+  volatile bool eventDisconnected = false;
+  volatile uint8_t disconnectReason = 0;
 };
 
 static WifiState wifi;
+RTC_NOINIT_ATTR static WifiCache rtcCache;
 
-// ======== CLOCK SYNC =================
-static void syncClockIfNeeded() {
-  if (WiFi.status() != WL_CONNECTED) {
-    wifi.clockSynced = false;
+// ======== EVENTS =====================
+static void onWifiEvent(arduino_event_id_t event, arduino_event_info_t info) {
+  switch (event) {
+    case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+      wifi.eventGotIP = true;
+      break;
+    case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+      wifi.disconnectReason = info.wifi_sta_disconnected.reason;
+      wifi.eventDisconnected = true;
+      break;
+    default:
+      break;
+  }
+}
+
+// ======== CONNECTION CACHE ===========
+static uint32_t cacheCrc(const WifiCache &cache) {
+  return crc32_le(0, (const uint8_t *)&cache, offsetof(WifiCache, crc));
+}
+
+static bool cacheValid(const WifiCache &cache) {
+  return cache.magic == WIFI_CACHE_MAGIC && cache.crc == cacheCrc(cache) &&
+         ACCESS_POINTS.count(String(cache.ssid)) > 0;
+}
+
+static void storeCache() {
+  WifiCache cache;
+  memset(&cache, 0, sizeof(cache));
+  cache.magic = WIFI_CACHE_MAGIC;
+  strlcpy(cache.ssid, WiFi.SSID().c_str(), sizeof(cache.ssid));
+  memcpy(cache.bssid, WiFi.BSSID(), sizeof(cache.bssid));
+  cache.channel = WiFi.channel();
+  cache.ip      = WiFi.localIP();
+  cache.gateway = WiFi.gatewayIP();
+  cache.subnet  = WiFi.subnetMask();
+  cache.dns     = WiFi.dnsIP();
+  cache.leaseStart = time(nullptr);
+  cache.crc     = cacheCrc(cache);
+
+  bool changed = memcmp(&cache, &rtcCache, offsetof(WifiCache, leaseStart)) != 0;
+  rtcCache = cache;
+  if (!changed) return;
+
+  // Only write flash when the access point or address really changed
+  Preferences prefs;
+  if (prefs.begin("wifi", false)) {
+    prefs.putBytes("cache", &cache, sizeof(cache));
+    prefs.end();
+  }
+}
+
+// Returns true if a cached connection was found. The IP configuration is only
+// reused after a soft reset, which keeps the system time, and while the lease
+// is young enough to be certain it has not expired. leaseLeft is the time in
+// seconds the address may still be used without DHCP.
+static bool loadCache(WifiCache &cache, time_t &leaseLeft) {
+  leaseLeft = 0;
+  if (esp_reset_reason() != ESP_RST_POWERON && cacheValid(rtcCache)) {
+    time_t age = time(nullptr) - rtcCache.leaseStart;
+    if (age >= 0 && age < LEASE_REUSE_MAX) leaseLeft = LEASE_REUSE_MAX - age;
+    cache = rtcCache;
+    return true;
+  }
+
+  Preferences prefs;
+  if (!prefs.begin("wifi", true)) return false;
+  size_t len = prefs.getBytes("cache", &cache, sizeof(cache));
+  prefs.end();
+
+  if (len != sizeof(cache) || !cacheValid(cache)) return false;
+  rtcCache = cache;
+  return true;
+}
+
+// ======== STATE MACHINE ==============
+static void startScan() {
+  // Asynchronous: returns immediately, result is polled with WiFi.scanComplete()
+  WiFi.scanDelete();
+  if (WiFi.scanNetworks(true) == WIFI_SCAN_FAILED) {
+    Serial.println("WiFi scan could not be started");
+  }
+  wifi.state = wsScanning;
+}
+
+static void startBackoff() {
+  wifi.backoff.interval = wifi.backoffInterval;
+  wifi.backoff.reset();
+  wifi.backoffInterval = min(2 * wifi.backoffInterval, BACKOFF_MAX);
+  wifi.state = wsBackoff;
+}
+
+static void beginAttempt(uint32_t timeout = CONNECT_TIMEOUT) {
+  wifi.eventGotIP = false;
+  wifi.eventDisconnected = false;
+  wifi.attempt.interval = timeout;
+  wifi.attempt.reset();
+  wifi.attemptStarted = millis();
+  wifi.state = wsConnecting;
+}
+
+// Connect straight to the cached access point, skipping the scan
+static bool startFastConnect() {
+  WifiCache cache;
+  time_t leaseLeft;
+  if (!loadCache(cache, leaseLeft)) return false;
+
+  // The static configuration is usable as soon as the link is up, DHCP takes
+  // over later, off the boot path
+  bool reuseIP = leaseLeft > 0;
+  if (reuseIP) {
+    WiFi.config(IPAddress(cache.ip), IPAddress(cache.gateway), IPAddress(cache.subnet), IPAddress(cache.dns));
+    wifi.leaseHandback.interval = leaseLeft * MS_PER_SEC;
+    wifi.leaseHandback.reset();
+  }
+  wifi.cachedIP = reuseIP;
+
+  Serial.printf("Connecting to cached %s, channel %u%s\n", cache.ssid, cache.channel, reuseIP ? ", cached IP" : "");
+  WiFi.begin(cache.ssid, ACCESS_POINTS[String(cache.ssid)].c_str(), cache.channel, cache.bssid);
+  beginAttempt(FAST_CONNECT_TIMEOUT);
+  wifi.fastConnect = true;
+  return true;
+}
+
+static void fastConnectFailed() {
+  Serial.println("Cached access point not reachable, scanning");
+  wifi.fastConnect = false;
+  wifi.cachedIP = false;
+  WiFi.disconnect();
+  WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE); // Back to DHCP
+  startScan();
+}
+
+// Connect to the strongest configured access point in the scan results
+static void connectToBestScanned(int16_t found) {
+  int best = -1;
+  for (int i = 0; i < found; i++) {
+    if (ACCESS_POINTS.count(WiFi.SSID(i)) == 0) continue;
+    wifi.knownChannels |= 1 << WiFi.channel(i);
+    if (best < 0 || WiFi.RSSI(i) > WiFi.RSSI(best)) best = i;
+  }
+
+  if (best < 0) {
+    WiFi.scanDelete();
+    Serial.println("No known access point found");
+    startBackoff();
     return;
   }
 
-  if (wifi.clockSynced && !wifi.syncClock.lapsed()) return;
+  String ssid = WiFi.SSID(best);
+  Serial.printf("Connecting to %s, channel %d, RSSI %d dBm\n", ssid.c_str(), WiFi.channel(best), WiFi.RSSI(best));
+  WiFi.begin(ssid.c_str(), ACCESS_POINTS[ssid].c_str(), WiFi.channel(best), WiFi.BSSID(best));
+  WiFi.scanDelete();
+  beginAttempt();
+}
 
-  Serial.println("Sync clock with NTP");
-  configTzTime(localTimezone,
-               "time.google.com",
-               "time.windows.com",
-               "pool.ntp.org");
+// Restart the escalation timers, counting from now
+static void resetEscalation(wifiEscalation_t level) {
+  wifi.escalation = level;
+  wifi.backoffInterval = BACKOFF_MIN;
+  wifi.reconnect1.reset();
+  wifi.reconnect2.reset();
+  wifi.reconnect3.reset();
+  wifi.restart.reset();
+}
 
-  struct tm timeinfo;
-  if (getLocalTime(&timeinfo, 2000)) {
-    wifi.clockSynced = true;
-    wifi.syncClock.reset();
-    addToEventLog("Time synced via NTP");
-    Serial.println("  Time sync OK");
+// Take the next recovery step once its escalation timer has lapsed
+static void escalate() {
+  if (wifi.escalation < weDeviceRestart && wifi.restart.lapsed()) {
+    wifi.escalation = weDeviceRestart;
+  } else if (wifi.escalation < weRadioRestart2 && wifi.reconnect3.lapsed()) {
+    wifi.escalation = weRadioRestart2;
+  } else if (wifi.escalation < weRadioRestart && wifi.reconnect2.lapsed()) {
+    wifi.escalation = weRadioRestart;
+  } else if (wifi.escalation < weSwitchAP && wifi.reconnect1.lapsed()) {
+    wifi.escalation = weSwitchAP;
+    addToEventLog("WiFi still down, switching access point");
   } else {
-    Serial.println("  Time sync failed");
+    // No new escalation step: retry the current one
+    if (wifi.escalation == weReconnect) {
+      WiFi.reconnect();
+      beginAttempt();
+    } else {
+      startScan();
+    }
+    return;
+  }
+
+  switch (wifi.escalation) {
+    case weRadioRestart:
+    case weRadioRestart2:
+      addToEventLog("WiFi still down, restarting radio");
+      WiFi.disconnect(true);
+      WiFi.mode(WIFI_OFF);
+      wifi.radioOff.reset();
+      wifi.state = wsRadioOff;
+      break;
+    case weDeviceRestart:
+      addToEventLog("WiFi still down, restarting ESP");
+      ESP.restart();
+      break;
+    default:
+      startScan();
+      break;
+  }
+}
+
+static void onConnected() {
+  // A disconnect seen before the address is the one from the previous access point
+  wifi.eventGotIP = false;
+  wifi.eventDisconnected = false;
+  wifi.associationTime = millis() - wifi.attemptStarted;
+  bootStageDone(bsWifi);
+  addToEventLogf("WiFi connected to %s, RSSI %d dBm, in %u ms%s",
+                 WiFi.SSID().c_str(), WiFi.RSSI(), wifi.associationTime,
+                 wifi.fastConnect ? " (cached)" : "");
+  if (wifi.roaming) {
+    wifi.roams++;
+    wifi.lastRoamDowntime = millis() - wifi.roamStarted;
+    addToEventLogf("Roamed to %s, downtime %u ms", WiFi.SSID().c_str(), wifi.lastRoamDowntime);
+  }
+
+  // The cached address is not a new lease
+  if (!wifi.cachedIP) storeCache();
+
+  wifi.fastConnect = false;
+  wifi.roaming = false;
+  wifi.rssiAverage16 = 16 * WiFi.RSSI();
+  wifi.knownChannels |= 1 << WiFi.channel();
+  wifi.state = wsConnected;
+  wifi.escalation = weReconnect;
+  wifi.backoffInterval = BACKOFF_MIN;
+}
+
+// ======== ROAMING ====================
+// Scan the next channel on which a configured SSID was seen before.
+// Returns false when all channels have been scanned.
+static bool scanNextRoamChannel() {
+  // Nothing known yet: one full scan
+  if (wifi.knownChannels == 0 && wifi.roamChannel == 0) {
+    wifi.roamChannel = 14;
+    WiFi.scanNetworks(true, false, false, ROAM_SCAN_TIME);
+    return true;
+  }
+
+  while (++wifi.roamChannel <= 13) {
+    if (wifi.knownChannels & (1 << wifi.roamChannel)) {
+      WiFi.scanNetworks(true, false, false, ROAM_SCAN_TIME, wifi.roamChannel);
+      return true;
+    }
+  }
+  return false;
+}
+
+static void startRoamScan() {
+  Serial.printf("Weak signal (%d dBm average), looking for a better access point\n", wifi.rssiAverage16 / 16);
+  wifi.roamCandidate.ssid = "";
+  wifi.roamCandidate.rssi = -127;
+  wifi.roamChannel = 0;
+  WiFi.scanDelete();
+  wifi.roamCooldown.reset();
+  wifi.state = scanNextRoamChannel() ? wsRoamScanning : wsConnected;
+}
+
+static void collectRoamCandidates(int16_t found) {
+  const uint8_t *current = WiFi.BSSID();
+
+  for (int i = 0; i < found; i++) {
+    if (ACCESS_POINTS.count(WiFi.SSID(i)) == 0) continue;
+    wifi.knownChannels |= 1 << WiFi.channel(i);
+    if (memcmp(WiFi.BSSID(i), current, 6) == 0) continue;
+    if (WiFi.RSSI(i) <= wifi.roamCandidate.rssi) continue;
+
+    wifi.roamCandidate.ssid    = WiFi.SSID(i);
+    wifi.roamCandidate.rssi    = WiFi.RSSI(i);
+    wifi.roamCandidate.channel = WiFi.channel(i);
+    memcpy(wifi.roamCandidate.bssid, WiFi.BSSID(i), 6);
+  }
+  WiFi.scanDelete();
+}
+
+static void finishRoamScan() {
+  const RoamCandidate &c = wifi.roamCandidate;
+  int average = wifi.rssiAverage16 / 16;
+
+  wifi.state = wsConnected;
+  if (c.ssid.length() == 0 || c.rssi < average + ROAM_HYSTERESIS) return;
+
+  addToEventLogf("Roaming from %s (%d dBm) to %s (%d dBm, channel %u)",
+                 WiFi.SSID().c_str(), average, c.ssid.c_str(), c.rssi, c.channel);
+
+  wifi.roaming = true;
+  wifi.roamStarted = millis();
+  WiFi.begin(c.ssid.c_str(), ACCESS_POINTS[c.ssid].c_str(), c.channel, c.bssid);
+  beginAttempt();
+}
+
+static void roamFailed() {
+  addToEventLog("Roaming failed, reconnecting");
+  wifi.roaming = false;
+  wifi.reconnects++;
+  resetEscalation(weSwitchAP);
+  startBackoff();
+}
+
+// Track the signal while connected and start a roam scan when it degrades
+static void monitorSignal() {
+  if (!wifi.roamSample.lapsed()) return;
+
+  wifi.rssiAverage16 += (16 * WiFi.RSSI() - wifi.rssiAverage16) / ROAM_AVERAGE_WEIGHT;
+
+  if (wifi.rssiAverage16 < 16 * ROAM_RSSI_THRESHOLD && wifi.roamCooldown.lapsed() && ACCESS_POINTS.size() > 0) {
+    startRoamScan();
+  }
+}
+
+static void onConnectionLost() {
+  addToEventLogf("WiFi disconnected (reason %u), reconnecting", wifi.disconnectReason);
+  wifi.reconnects++;
+  resetEscalation(weReconnect);
+
+  // First retry immediately, the back-off starts from the second one
+  WiFi.reconnect();
+  beginAttempt();
+}
+
+// The cached lease is getting old: let DHCP take over. Starting the client
+// clears the address, so the connection counts as down until it has a lease.
+static void startLeasing() {
+  Serial.println("Cached IP configuration expires, switching to DHCP");
+  wifi.cachedIP = false;
+  WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE);
+  wifi.eventGotIP = false;
+  wifi.attempt.interval = CONNECT_TIMEOUT;
+  wifi.attempt.reset();
+  wifi.state = wsLeasing;
+}
+
+static void runStateMachine() {
+  switch (wifi.state) {
+    case wsConnected:
+      if (wifi.eventDisconnected) {
+        onConnectionLost();
+        break;
+      }
+      if (wifi.eventGotIP) {
+        // Bound or renewed by DHCP
+        wifi.eventGotIP = false;
+        if (!wifi.cachedIP) storeCache();
+      }
+      if (wifi.cachedIP && wifi.leaseHandback.lapsed()) startLeasing();
+      else monitorSignal();
+      break;
+
+    case wsLeasing:
+      if (wifi.eventDisconnected) {
+        onConnectionLost();
+      } else if (wifi.eventGotIP) {
+        wifi.eventGotIP = false;
+        storeCache();
+        wifi.state = wsConnected;
+      } else if (wifi.attempt.lapsed()) {
+        addToEventLog("WiFi got no DHCP lease, reconnecting");
+        WiFi.disconnect();
+        wifi.reconnects++;
+        resetEscalation(weReconnect);
+        startBackoff();
+      }
+      break;
+
+    case wsRoamScanning: {
+      if (wifi.eventDisconnected) {
+        WiFi.scanDelete();
+        onConnectionLost();
+        break;
+      }
+      int16_t found = WiFi.scanComplete();
+      if (found == WIFI_SCAN_RUNNING) break;
+      if (found > 0) collectRoamCandidates(found);
+      if (!scanNextRoamChannel()) finishRoamScan();
+      break;
+    }
+
+    case wsConnecting:
+      // ASSOC_LEAVE is our own disconnect from the previous access point, it
+      // may arrive after beginAttempt() when WiFi.begin() left a connection
+      if (wifi.eventDisconnected && wifi.disconnectReason == WIFI_REASON_ASSOC_LEAVE) {
+        wifi.eventDisconnected = false;
+      }
+
+      if (wifi.eventGotIP) {
+        onConnected();
+      } else if (wifi.eventDisconnected || wifi.attempt.lapsed()) {
+        if (wifi.fastConnect) fastConnectFailed();
+        else if (wifi.roaming) roamFailed();
+        else startBackoff();
+      }
+      break;
+
+    case wsBackoff:
+      if (wifi.backoff.lapsed()) escalate();
+      break;
+
+    case wsScanning: {
+      int16_t found = WiFi.scanComplete();
+      if (found == WIFI_SCAN_RUNNING) break;
+      if (found == WIFI_SCAN_FAILED) startBackoff();
+      else connectToBestScanned(found);
+      break;
+    }
+
+    case wsRadioOff:
+      if (wifi.radioOff.lapsed()) {
+        WiFi.mode(WIFI_STA);
+        startScan();
+      }
+      break;
   }
 }
 
@@ -60,45 +526,40 @@ static void syncClockIfNeeded() {
 void setupWifi() {
   Serial.println("Initialize WiFi");
 
+  WiFi.onEvent(onWifiEvent);
   WiFi.mode(WIFI_STA);
-  WiFi.setSleep(false);
-  WiFi.setAutoReconnect(true);
-
-  for (const auto &ap : ACCESS_POINTS) {
-    wifi.multi.addAP(ap.first.c_str(), ap.second.c_str());
-  }
+  // Modem sleep wakes at every DTIM beacon, long enough for pending replies
+  WiFi.setSleep(powerSaveEnabled() ? WIFI_PS_MIN_MODEM : WIFI_PS_NONE);
+  WiFi.setAutoReconnect(false); // Reconnects are handled by the state machine
 
   esp_err_t err = esp_wifi_set_max_tx_power(78);
   if (err != ESP_OK) {
     addToEventLog(String("TX power set failed: ") + String(err));
   }
 
-  Serial.println("Connecting WiFi...");
-  if (wifi.multi.run(CONNECT_TIMEOUT_BOOT) == WL_CONNECTED) {
-    addToEventLog(String("WiFi connected to ") + WiFi.SSID() +
-                  ", RSSI " + String(WiFi.RSSI()) + " dBm");
-  } else {
-    addToEventLog("WiFi not connected yet");
-  }
+  // The connection is made in the background by loopWifi(). Try the cached
+  // access point first and fall back to a scan.
+  resetEscalation(weSwitchAP);
+  if (!startFastConnect()) startScan();
 
-  syncClockIfNeeded();
+  addPeriodicJob("wifi", loopWifi, 100, jpNetwork, 20);
 }
 
 // ======== LOOP =======================
 void loopWifi() {
-  static unsigned long lastCheck = 0;
-  const unsigned long CHECK_INTERVAL_MS = 10000;
-
-  syncClockIfNeeded();
+  runStateMachine();
+}
 
-  if (millis() - lastCheck < CHECK_INTERVAL_MS) return;
+bool wifiIsConnected() {
+  return wifi.state == wsConnected;
+}
 
-  lastCheck = millis();
+uint32_t wifiAssociationTime() {
+  return wifi.associationTime;
+}
 
-  if (WiFi.status() != WL_CONNECTED) {
-    addToEventLog("WiFi disconnected, retrying...");
-    wifi.multi.run();   // triggers scan + reconnect
-  }
+uint32_t wifiReconnectCount() {
+  return wifi.reconnects;
 }
 
 String wifiConnectedTo() {
@@ -124,6 +585,11 @@ String wifiConnectedTo() {
     } else {
       result+="○○○○○";
     }
+
+    if (wifi.roams > 0) {
+      result += String("\nRoamed ") + String(wifi.roams) + " times, last downtime " +
+                String(wifi.lastRoamDowntime) + " ms";
+    }
   }
 
   return result;
@@ -5,4 +5,7 @@
 // Public WiFi interface
 void setupWifi();
 void loopWifi();
+bool wifiIsConnected();
 String wifiConnectedTo();
+uint32_t wifiAssociationTime(); // Duration of the last successful connect in ms
+uint32_t wifiReconnectCount(); // Number of reconnect attempts since boot
@@ -0,0 +1,87 @@
+// Unit tests of the event log ring in eventLog.cpp, run with: pio test -e native
+#include <unity.h>
+#include <string.h>
+
+#include "eventlog.h"
+#include "localclock.h"
+#include "native/hal_linux.h"
+
+static const time_t JULY_1_16H = 1751385600; // 2025-07-01 16:00:00 UTC
+
+void setUp() {
+  halLinuxVirtualTime(JULY_1_16H);
+  localClockSetZone("UTC0");
+  localClockTick();
+  clearEventLog();
+}
+
+void tearDown() {}
+
+static void test_entries_are_stamped() {
+  addToEventLog("Fan switched on");
+  addToEventLogf("Job %s overran: %u ms", "fan", 12u);
+
+  TEST_ASSERT_EQUAL_STRING("2025-07-01 16:00:00 - Fan switched on\n"
+                           "2025-07-01 16:00:00 - Job fan overran: 12 ms",
+                           getEventLogAsString().c_str());
+}
+
+static void test_ring_keeps_the_newest() {
+  for (int i = 0; i < (int)EVENTLOG_SIZE + 5; i++) addToEventLogf("event %d", i);
+
+  String log = getEventLogAsString();
+  TEST_ASSERT_TRUE(log.startsWith("2025-07-01 16:00:00 - event 5\n"));
+  TEST_ASSERT_TRUE(log.endsWith("event 24"));
+  TEST_ASSERT_EQUAL_INT(-1, log.indexOf("event 4\n"));
+}
+
+static void test_records_by_sequence() {
+  uint32_t first = eventLogNextSequence();
+  addToEventLog("one");
+  addToEventLog("two");
+  TEST_ASSERT_EQUAL_UINT32(first + 2, eventLogNextSequence());
+
+  time_t when;
+  const char *text;
+  TEST_ASSERT_TRUE(eventLogRecord(first + 1, when, text));
+  TEST_ASSERT_EQUAL_STRING("two", text);
+  TEST_ASSERT_EQUAL(JULY_1_16H, when);
+  TEST_ASSERT_FALSE(eventLogRecord(first + 2, when, text)); // Not written yet
+
+  for (size_t i = 0; i < EVENTLOG_SIZE; i++) addToEventLog("filler");
+  TEST_ASSERT_FALSE(eventLogRecord(first, when, text));     // Overwritten
+}
+
+static void test_clear_keeps_the_sequence() {
+  addToEventLog("before");
+  uint32_t next = eventLogNextSequence();
+  clearEventLog();
+
+  time_t when;
+  const char *text;
+  TEST_ASSERT_EQUAL_STRING("", getEventLogAsString().c_str());
+  TEST_ASSERT_FALSE(eventLogRecord(next - 1, when, text));
+  TEST_ASSERT_EQUAL_UINT32(next, eventLogNextSequence());
+}
+
+static void test_stash_hides_benchmark_entries() {
+  addToEventLog("kept");
+  uint32_t next = eventLogNextSequence();
+
+  stashEventLog();
+  addToEventLog("benchmark");
+  unstashEventLog();
+
+  TEST_ASSERT_EQUAL_STRING("2025-07-01 16:00:00 - kept", getEventLogAsString().c_str());
+  TEST_ASSERT_EQUAL_UINT32(next, eventLogNextSequence());
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_entries_are_stamped);
+  RUN_TEST(test_ring_keeps_the_newest);
+  RUN_TEST(test_records_by_sequence);
+  RUN_TEST(test_clear_keeps_the_sequence);
+  RUN_TEST(test_stash_hides_benchmark_entries);
+  return UNITY_END();
+}
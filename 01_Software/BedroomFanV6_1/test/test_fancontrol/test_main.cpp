@@ -0,0 +1,122 @@
+// Unit tests of the fan modes in fancontrol.cpp, run with: pio test -e native
+//
+// The clock is the virtual clock of the Linux HAL, so the tests step through
+// timers and clock windows without waiting.
+#include <unity.h>
+
+#include "fancontrol.h"
+#include "localclock.h"
+#include "rtcstate.h"
+#include "native/hal_linux.h"
+
+static const time_t JULY_1_16H = 1751385600; // 2025-07-01 16:00:00 UTC
+
+static void advanceMinutes(uint32_t minutes) {
+  halLinuxAdvance(minutes * MS_PER_MIN);
+  localClockTick();
+}
+
+void setUp() {
+  halLinuxVirtualTime(JULY_1_16H);
+  localClockSetZone("UTC0");
+  localClockTick();
+  setFanModeOff();
+  clock_on = TimeOfDay(16, 30);
+  clock_off = TimeOfDay(22, 0);
+}
+
+void tearDown() {}
+
+static void test_mode_on_and_off() {
+  setFanModeOn();
+  TEST_ASSERT_TRUE(fanIsOn());
+  TEST_ASSERT_EQUAL(C_ON, halDigitalRead(RELAY_PIN));
+  TEST_ASSERT_EQUAL_STRING("on", fanModeName());
+
+  setFanModeOff();
+  TEST_ASSERT_FALSE(fanIsOn());
+  TEST_ASSERT_EQUAL(C_OFF, halDigitalRead(RELAY_PIN));
+  TEST_ASSERT_EQUAL_STRING("off", fanModeName());
+}
+
+static void test_timer_lapses() {
+  setFanModeTimer(tdTimer20);
+  TEST_ASSERT_TRUE(fanIsOn());
+  TEST_ASSERT_EQUAL_STRING("timer20", fanModeName());
+  TEST_ASSERT_EQUAL_UINT32(20, fanTimerMinutes());
+
+  advanceMinutes(19);
+  loopFan();
+  TEST_ASSERT_TRUE(fanIsOn());
+  TEST_ASSERT_EQUAL_UINT32(1, fanTimerMinutes());
+
+  advanceMinutes(1);
+  loopFan();
+  TEST_ASSERT_FALSE(fanIsOn());
+  TEST_ASSERT_EQUAL_UINT32(0, fanTimerMinutes());
+}
+
+static void test_clock_window() {
+  setFanModeClock();
+  loopFan();
+  TEST_ASSERT_FALSE(fanIsOn()); // 16:00
+
+  advanceMinutes(29);
+  loopFan();
+  TEST_ASSERT_FALSE(fanIsOn()); // 16:29
+
+  advanceMinutes(1);
+  loopFan();
+  TEST_ASSERT_TRUE(fanIsOn());  // 16:30
+
+  advanceMinutes(5 * 60 + 29);
+  loopFan();
+  TEST_ASSERT_TRUE(fanIsOn());  // 21:59
+
+  advanceMinutes(1);
+  loopFan();
+  TEST_ASSERT_FALSE(fanIsOn()); // 22:00
+}
+
+static void test_on_time_and_switches() {
+  uint32_t seconds = fanOnSeconds();
+  uint32_t switches = fanSwitchCount();
+
+  setFanModeOn();
+  advanceMinutes(2);
+  setFanModeOn(); // Already on, no switch
+  setFanModeOff();
+  advanceMinutes(5);
+
+  TEST_ASSERT_EQUAL_UINT32(seconds + 120, fanOnSeconds());
+  TEST_ASSERT_EQUAL_UINT32(switches + 2, fanSwitchCount());
+}
+
+// A reset right after the restore must find the timer remaining, not its full duration
+static void test_snapshot_keeps_timer_remaining() {
+  setFanModeTimer(tdTimer60);
+  advanceMinutes(15);
+  saveStateSnapshot();
+
+  // Lost in the reset, without a snapshot
+  fanMode = fsOff;
+  switchOffFan();
+
+  TEST_ASSERT_TRUE(restoreStateSnapshot());
+  TEST_ASSERT_TRUE(fanIsOn());
+  TEST_ASSERT_EQUAL_STRING("timer60", fanModeName());
+  TEST_ASSERT_EQUAL_UINT32(45, fanTimerMinutes());
+
+  TEST_ASSERT_TRUE(restoreStateSnapshot());
+  TEST_ASSERT_EQUAL_UINT32(45, fanTimerMinutes());
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_mode_on_and_off);
+  RUN_TEST(test_timer_lapses);
+  RUN_TEST(test_clock_window);
+  RUN_TEST(test_on_time_and_switches);
+  RUN_TEST(test_snapshot_keeps_timer_remaining);
+  return UNITY_END();
+}
@@ -0,0 +1,27 @@
+// Replays a recorded Telegram session and compares the transcript with the
+// golden file, see src/native/replay.h. Run with: pio test -e native
+//
+// pio test starts the program in the project directory. The same check by
+// hand, and the update of the golden file after an intended change:
+//   .pio/build/native/program --replay test/replay/updates.txt --golden test/replay/golden.txt
+//   .pio/build/native/program --replay test/replay/updates.txt --golden test/replay/golden.txt --update
+#include <unity.h>
+
+#include "native/replay.h"
+
+void setUp() {}
+void tearDown() {}
+
+static void test_transcript_matches_golden() {
+  char recording[] = "test/replay/updates.txt";
+  char option[] = "--golden";
+  char golden[] = "test/replay/golden.txt";
+  char *argv[] = { recording, option, golden };
+  TEST_ASSERT_EQUAL_INT(0, runReplay(3, argv));
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_transcript_matches_golden);
+  return UNITY_END();
+}
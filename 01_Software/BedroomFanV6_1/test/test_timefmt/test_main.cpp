@@ -0,0 +1,81 @@
+// Unit tests of timefmt.h and TimeOfDay, run with: pio test -e native
+#include <unity.h>
+#include <string.h>
+
+#include "clock.h"
+#include "timefmt.h"
+
+void setUp() {}
+void tearDown() {}
+
+static void test_format_clock() {
+  TEST_ASSERT_EQUAL_STRING("07:05", formatClock(7 * 60 + 5).c_str());
+  TEST_ASSERT_EQUAL_STRING("7:05", formatClock(7 * 60 + 5, false).c_str());
+  TEST_ASSERT_EQUAL_STRING("00:00", formatClock(0).c_str());
+  TEST_ASSERT_EQUAL_STRING("23:59", formatClock(23 * 60 + 59).c_str());
+}
+
+static void test_format_timestamp() {
+  struct tm t = {};
+  t.tm_year = 2025 - 1900;
+  t.tm_mon = 11;
+  t.tm_mday = 31;
+  t.tm_hour = 23;
+  t.tm_min = 59;
+  t.tm_sec = 58;
+  TEST_ASSERT_EQUAL_STRING("2025-12-31 23:59:58", formatTimestamp(t).c_str());
+}
+
+static void test_parse_clock() {
+  int minutes = -1;
+  TEST_ASSERT_TRUE(parseClock("8:05", minutes));
+  TEST_ASSERT_EQUAL_INT(8 * 60 + 5, minutes);
+  TEST_ASSERT_TRUE(parseClock("  23:59", minutes));
+  TEST_ASSERT_EQUAL_INT(23 * 60 + 59, minutes);
+  TEST_ASSERT_TRUE(parseClock("00:00 tomorrow", minutes));
+  TEST_ASSERT_EQUAL_INT(0, minutes);
+}
+
+static void test_parse_clock_rejects() {
+  const char *bad[] = { "24:00", "7:60", "7.30", ":30", "7:", "", "ab:cd", "123:00", "7:123" };
+  for (const char *text : bad) {
+    int minutes = 42;
+    TEST_ASSERT_FALSE_MESSAGE(parseClock(text, minutes), text);
+    TEST_ASSERT_EQUAL_INT_MESSAGE(42, minutes, text); // Unchanged
+  }
+}
+
+static void test_time_of_day() {
+  TimeOfDay t(7, 30);
+  TEST_ASSERT_EQUAL_STRING("07:30", t.to_string().c_str());
+  TEST_ASSERT_EQUAL_STRING("7:30", t.text().c_str());
+
+  t.add_minutes(45);
+  TEST_ASSERT_EQUAL_INT(8 * 60 + 15, t.minutes_after_midnight);
+  t.add_minutes(16 * 60);
+  TEST_ASSERT_EQUAL_INT(15, t.minutes_after_midnight); // Past midnight
+
+  TEST_ASSERT_TRUE(t.parse("16:30"));
+  TEST_ASSERT_FALSE(t.is_due(16, 29));
+  TEST_ASSERT_TRUE(t.is_due(16, 30));
+  TEST_ASSERT_TRUE(t.is_due(23, 0));
+
+  TEST_ASSERT_FALSE(t.parse("25:00"));
+  TEST_ASSERT_EQUAL_INT(16 * 60 + 30, t.minutes_after_midnight);
+}
+
+static void test_time_of_day_range() {
+  TEST_ASSERT_EQUAL_INT(0, TimeOfDay(-1, 0).minutes_after_midnight);
+  TEST_ASSERT_EQUAL_INT(24 * 60 - 1, TimeOfDay(24, 0).minutes_after_midnight);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_format_clock);
+  RUN_TEST(test_format_timestamp);
+  RUN_TEST(test_parse_clock);
+  RUN_TEST(test_parse_clock_rejects);
+  RUN_TEST(test_time_of_day);
+  RUN_TEST(test_time_of_day_range);
+  return UNITY_END();
+}
@@ -0,0 +1,33 @@
+#!/usr/bin/env python3
+"""Compress web/status.html into src/statuspage.h, run after editing the page.
+
+The page is stored gzipped in flash and served as is with Content-Encoding:
+gzip. The ETag is derived from the compressed bytes, so it changes with
+every edit of the page.
+"""
+
+import gzip
+import hashlib
+import os
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+SOURCE = os.path.join(ROOT, "web", "status.html")
+TARGET = os.path.join(ROOT, "src", "statuspage.h")
+
+with open(SOURCE, "rb") as f:
+    page = gzip.compress(f.read(), compresslevel=9, mtime=0)
+
+etag = hashlib.sha1(page).hexdigest()[:16]
+lines = [", ".join("0x%02x" % b for b in page[i:i + 16]) for i in range(0, len(page), 16)]
+
+with open(TARGET, "w") as f:
+    f.write("#pragma once\n\n")
+    f.write("// Generated from web/status.html by tools/embed_page.py, do not edit\n\n")
+    f.write("#include <stdint.h>\n#include <stddef.h>\n\n")
+    f.write('constexpr char STATUS_PAGE_ETAG[] = "\\"%s\\"";\n\n' % etag)
+    f.write("constexpr size_t STATUS_PAGE_SIZE = %d;\n\n" % len(page))
+    f.write("const uint8_t STATUS_PAGE_GZIP[STATUS_PAGE_SIZE] = {\n")
+    f.write("".join("  %s,\n" % line for line in lines))
+    f.write("};\n")
+
+print("%s: %d bytes, %d gzipped, ETag %s" % (os.path.relpath(TARGET, ROOT), os.path.getsize(SOURCE), len(page), etag))
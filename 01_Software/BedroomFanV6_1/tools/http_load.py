@@ -0,0 +1,106 @@
+#!/usr/bin/env python3
+"""Load test of the HTTP server, against the board or the Linux build.
+
+  program --http 8080 &
+  tools/http_load.py localhost:8080 --requests 2000 --concurrency 4
+
+Sends a mix of status, page and command requests from several clients at
+once and prints the response time percentiles per endpoint. A response time
+runs from connect until the server closed the connection. Exits with 1 if a
+request failed or the page was not served from the ETag cache.
+"""
+
+import argparse
+import http.client
+import sys
+import threading
+import time
+
+MIX = [
+    ("GET", "/api/status"),
+    ("GET", "/api/status"),
+    ("GET", "/"),
+    ("GET", "/?cached"),
+    ("POST", "/api/fan/on"),
+    ("POST", "/api/fan/clock"),
+    ("POST", "/api/clock/on?shift=15"),
+    ("POST", "/api/clock/on?shift=-15"),
+    ("GET", "/api/eventlog"),
+]
+
+
+def percentile(values, p):
+    values = sorted(values)
+    return values[min(len(values) - 1, int(p / 100 * len(values)))]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("server", help="host:port")
+    parser.add_argument("--requests", type=int, default=1000)
+    parser.add_argument("--concurrency", type=int, default=4)
+    args = parser.parse_args()
+    host, _, port = args.server.partition(":")
+    port = int(port or 80)
+
+    # ETag of the page, for the cached requests
+    connection = http.client.HTTPConnection(host, port, timeout=5)
+    connection.request("GET", "/")
+    response = connection.getresponse()
+    response.read()
+    etag = response.getheader("ETag")
+    connection.close()
+
+    times = {}
+    failures = []
+    lock = threading.Lock()
+    counter = iter(range(args.requests))
+
+    def client():
+        for i in counter:
+            method, path = MIX[i % len(MIX)]
+            headers = {}
+            if path == "/?cached":
+                path = "/"
+                headers["If-None-Match"] = etag
+                label = "GET / (cached)"
+            else:
+                label = method + " " + path
+            start = time.perf_counter()
+            try:
+                connection = http.client.HTTPConnection(host, port, timeout=5)
+                connection.request(method, path, headers=headers)
+                response = connection.getresponse()
+                response.read()
+                connection.close()
+                expected = 304 if headers else 200
+                ok = response.status == expected
+            except OSError as error:
+                ok, response = False, error
+            elapsed = (time.perf_counter() - start) * 1000
+            with lock:
+                times.setdefault(label, []).append(elapsed)
+                if not ok:
+                    failures.append("%s: %s" % (label, getattr(response, "status", response)))
+
+    start = time.perf_counter()
+    threads = [threading.Thread(target=client) for _ in range(args.concurrency)]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    duration = time.perf_counter() - start
+
+    print("%d requests in %.2f s, %.0f per second, %d clients" %
+          (args.requests, duration, args.requests / duration, args.concurrency))
+    print("%-32s %6s %7s %7s %7s %7s" % ("endpoint [ms]", "count", "p50", "p95", "p99", "max"))
+    for label, values in sorted(times.items()):
+        print("%-32s %6d %7.2f %7.2f %7.2f %7.2f" % (label, len(values), percentile(values, 50),
+              percentile(values, 95), percentile(values, 99), max(values)))
+    for failure in failures[:10]:
+        print("failed:", failure)
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,120 @@
+#!/usr/bin/env python3
+"""Scrapes /metrics like Prometheus would and checks the exposition format.
+
+  program --http 8080 &
+  tools/scrape_metrics.py localhost:8080 --scrapes 200
+
+Every scrape is parsed: each sample needs a # TYPE for its family, the
+buckets of a histogram must not decrease and end in +Inf equal to _count,
+and counters must not go down between scrapes. Prints the scrape times and
+the last scrape with --show. Exits with 1 on the first problem.
+"""
+
+import argparse
+import http.client
+import re
+import sys
+import time
+
+SAMPLE = re.compile(r'^([a-zA-Z_:][a-zA-Z0-9_:]*)(\{([^}]*)\})? (\S+)$')
+LABEL = re.compile(r'([a-zA-Z_][a-zA-Z0-9_]*)="([^"\\]*)"')
+
+
+def scrape(host, port):
+    start = time.perf_counter()
+    connection = http.client.HTTPConnection(host, port, timeout=5)
+    connection.request("GET", "/metrics")
+    response = connection.getresponse()
+    body = response.read().decode()
+    connection.close()
+    elapsed = (time.perf_counter() - start) * 1000
+    if response.status != 200:
+        raise ValueError("status %d" % response.status)
+    if not response.getheader("Content-Type", "").startswith("text/plain; version=0.0.4"):
+        raise ValueError("content type %s" % response.getheader("Content-Type"))
+    return body, elapsed
+
+
+def parse(body):
+    """Returns {(name, labels): value} and {family: type}, raises on a bad line."""
+    types, samples = {}, {}
+    for line in body.splitlines():
+        if line.startswith("# TYPE "):
+            _, _, family, kind = line.split(" ", 3)
+            if family in types:
+                raise ValueError("TYPE of %s twice" % family)
+            types[family] = kind
+            continue
+        if line.startswith("#") or not line:
+            continue
+        match = SAMPLE.match(line)
+        if not match:
+            raise ValueError("bad line: %r" % line)
+        name, labels, value = match.group(1), tuple(LABEL.findall(match.group(3) or "")), float(match.group(4))
+        family = re.sub(r'_(bucket|sum|count)$', '', name) if name not in types else name
+        if family not in types:
+            raise ValueError("no TYPE for %s" % name)
+        if (name, labels) in samples:
+            raise ValueError("duplicate sample %s%s" % (name, labels))
+        samples[(name, labels)] = value
+    return samples, types
+
+
+def check_histograms(samples, types):
+    for family, kind in types.items():
+        if kind != "histogram":
+            continue
+        series = {}
+        for (name, labels), value in samples.items():
+            if name == family + "_bucket":
+                rest = tuple(l for l in labels if l[0] != "le")
+                le = dict(labels)["le"]
+                series.setdefault(rest, []).append((float("inf") if le == "+Inf" else float(le), value))
+        for rest, buckets in series.items():
+            buckets.sort()
+            counts = [v for _, v in buckets]
+            if counts != sorted(counts):
+                raise ValueError("%s%s buckets decrease" % (family, rest))
+            if buckets[-1][0] != float("inf") or counts[-1] != samples[(family + "_count", rest)]:
+                raise ValueError("%s%s +Inf differs from _count" % (family, rest))
+
+
+def check_counters(previous, samples, types):
+    for (name, labels), value in samples.items():
+        if types.get(name) == "counter" and value < previous.get((name, labels), 0):
+            raise ValueError("counter %s%s went down" % (name, labels))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("server", help="host:port")
+    parser.add_argument("--scrapes", type=int, default=100)
+    parser.add_argument("--show", action="store_true", help="print the last scrape")
+    args = parser.parse_args()
+    host, _, port = args.server.partition(":")
+    port = int(port or 80)
+
+    times, previous, body = [], {}, ""
+    try:
+        for _ in range(args.scrapes):
+            body, elapsed = scrape(host, port)
+            times.append(elapsed)
+            samples, types = parse(body)
+            check_histograms(samples, types)
+            check_counters(previous, samples, types)
+            previous = samples
+    except (OSError, ValueError) as error:
+        print("scrape %d failed: %s" % (len(times), error))
+        return 1
+
+    if args.show:
+        print(body)
+    times.sort()
+    print("%d scrapes of %d samples, %d bytes" % (len(times), len(previous), len(body)))
+    print("scrape time [ms]: p50 %.2f, p95 %.2f, max %.2f" %
+          (times[len(times) // 2], times[int(len(times) * 0.95)], times[-1]))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,77 @@
+#!/usr/bin/env python3
+"""Receives the remote log of the fan and checks it.
+
+  tools/syslog_listen.py --port 5514 &
+  program --syslog localhost:5514
+
+Every datagram holds one RFC 5424 message (RFC 5426). Each one is parsed
+and printed, and its meta sequenceId is checked against the one
+before: a jump is reported as lost records, a repeat as a duplicate. Prints
+a summary after --seconds, or on Ctrl-C. Exits with 1 if a line did not
+parse.
+"""
+
+import argparse
+import re
+import socket
+import sys
+import time
+
+MESSAGE = re.compile(r'^<(\d{1,3})>1 (\S+) (\S+) (\S+) (\S+) (\S+) (-|(?:\[[^\]]*\])+) ?(.*)$')
+SEQUENCE = re.compile(r'\[meta [^\]]*sequenceId="(\d+)"')
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--port", type=int, default=5514)
+    parser.add_argument("--seconds", type=float, default=0, help="0 runs until Ctrl-C")
+    parser.add_argument("--quiet", action="store_true", help="only the summary")
+    args = parser.parse_args()
+
+    sock = socket.socket(socket.AF_INET6, socket.SOCK_DGRAM)
+    sock.setsockopt(socket.IPPROTO_IPV6, socket.IPV6_V6ONLY, 0)
+    sock.bind(("::", args.port))
+    end = time.monotonic() + args.seconds if args.seconds else None
+
+    datagrams = messages = lost = duplicates = bad = 0
+    sizes = []
+    last = None
+    try:
+        while end is None or time.monotonic() < end:
+            sock.settimeout(max(0.01, end - time.monotonic()) if end else None)
+            try:
+                data, _ = sock.recvfrom(65535)
+            except socket.timeout:
+                continue
+            datagrams += 1
+            sizes.append(len(data))
+
+            # A collector reads the whole datagram as one message, so must we
+            line = data.decode("utf-8", "replace")
+            match = MESSAGE.match(line)
+            sequence = SEQUENCE.search(line)
+            if not match or not sequence:
+                bad += 1
+                print("bad message: %r" % line)
+                continue
+            messages += 1
+            sequence = int(sequence.group(1))
+            if last is not None and sequence > last + 1:
+                lost += sequence - last - 1
+                print("-- %d lost before sequenceId %d" % (sequence - last - 1, sequence))
+            elif last is not None and sequence <= last:
+                duplicates += 1
+                print("-- sequenceId %d again after %d" % (sequence, last))
+            last = sequence
+            if not args.quiet:
+                print("%5d %s %s" % (sequence, match.group(2), match.group(8)))
+    except KeyboardInterrupt:
+        pass
+
+    print("%d messages in %d datagrams (%.0f bytes average), %d lost, %d duplicates, %d bad" %
+          (messages, datagrams, sum(sizes) / max(1, len(sizes)), lost, duplicates, bad))
+    return 1 if bad else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())